@@ -1,9 +1,14 @@
 #pragma once
 
+#include "DSP/PulseSequenceCache.h"
+#include "DSP/PartitionedConvolver.h"
+#include <array>
 #include <vector>
+#include <memory>
 #include <cmath>
 #include <cstdint>
 #include <algorithm>
+#include <limits>
 
 namespace DSP
 {
@@ -14,111 +19,274 @@ namespace DSP
  * Fixed: energy normalisation added so that the sparse FIR has
  * approximately unity RMS gain, matching Fagerström et al. (2020)
  * equation (15) normalisation requirement.
+ *
+ * Density, tail length and the pulse cap are configurable (setConfig(),
+ * applied at prepare()).  Pulses sit on a fractional grid of
+ * sampleRate / density samples, so the pulse count is density x length
+ * at any sample rate.  Where that grid is a whole number of samples the
+ * layout is the one the old integer grid produced; elsewhere (44.1 kHz
+ * at 1800 pulses/s: 24.5 samples, previously truncated to 24) positions
+ * intentionally moved, as the truncated grid packed too many pulses into
+ * the cap and shortened the tail.  The default keeps the original 500-pulse cap
+ * (~0.28 s at 1800 pulses/s); maxPulses = 0 uses the full length, where
+ * the sparse cost grows with density x length and the FFT engine keeps
+ * it flat.
+ *
+ * Pulse positions / signs / widths depend only on (sample rate, seed,
+ * config) and are shared between instances through PulseSequenceCache; only
+ * the RT60-dependent envelopes are per instance.
+ *
+ * Envelope coefficients are double-buffered.  setParameters() is cheap
+ * when nothing changed; when it did, the inactive table is rebuilt a
+ * slice of pulses per call and swapped in once complete, so an RT60
+ * ramp costs at most kEnvelopePulsesPerBlock std::exp pairs per block.
+ * Tables hold unnormalised coefficients plus one gain, so completing a
+ * build never has to revisit every pulse.
+ *
+ * Two convolution engines share the same envelope tables.  The sparse
+ * engine evaluates every pulse in the time domain (cost ~ pulses x
+ * samples).  The FFT engine evaluates only the pulses in the first
+ * partition sparsely and renders the rest to a dense IR for a
+ * PartitionedConvolver, whose one-partition latency is exactly covered
+ * by that sparse head.  The dense IR is scattered straight into the
+ * convolver's staging buffer slice by slice with the envelopes, and the
+ * normalisation gain is applied as each partition is transformed, so no
+ * block does work proportional to the tail length.  Engine::automatic
+ * picks the cheaper one (the processor uses it); prepare() defaults to
+ * sparse so standalone instances keep the smaller memory footprint.
  */
 class DarkVelvetNoise
 {
 public:
+    struct LayoutPulse
+    {
+        int position;
+        float sign;
+        int width;
+    };
+
+    /** Immutable DVN pulse layout, shareable between instances. */
+    struct PulseLayout
+    {
+        std::vector<LayoutPulse> pulses;
+        int length = 0;
+    };
+
+    struct Config
+    {
+        float density = 1800.0f;       // pulses per second
+        float lengthSeconds = 3.0f;    // maximum tail length
+        int maxPulses = 500;           // pulse cap; 0 = density x length
+        int leadSamples = 0;           // taps fire this much early (pulses
+                                       // inside it at once), e.g. to absorb
+                                       // a resampler round trip
+    };
+
+    static constexpr int kEnvelopePulsesPerBlock = 256;
+    static constexpr int kMinFFTPartition = 512;
+
+    enum class Engine
+    {
+        automatic,
+        sparse,
+        fft
+    };
+
     DarkVelvetNoise() = default;
 
-    void prepare (double sampleRate, int maxBlockSize, uint32_t seed)
+    /** Takes effect at the next prepare(); all buffers are sized there. */
+    void setConfig (const Config& newConfig)
+    {
+        config.density = std::max (1.0f, newConfig.density);
+        config.lengthSeconds = std::max (0.01f, newConfig.lengthSeconds);
+        config.maxPulses = std::max (0, newConfig.maxPulses);
+        config.leadSamples = std::max (0, newConfig.leadSamples);
+    }
+
+    const Config& getConfig() const { return config; }
+
+    void prepare (double sampleRate, int maxBlockSize, uint32_t seed,
+                  Engine engine = Engine::sparse)
     {
         sr = sampleRate;
-        generateDVNSequence (seed);
-        inputRingBuffer.resize (static_cast<size_t> (maxBlockSize + dvnLength + 16), 0.0f);
+        leadSamples = config.leadSamples;
+
+        // A pulse cap is just a shorter layout at the same density
+        float lengthSeconds = config.lengthSeconds;
+        if (config.maxPulses > 0)
+            lengthSeconds = std::min (lengthSeconds, static_cast<float> (config.maxPulses) / config.density);
+
+        const float density = config.density;
+        layout = PulseSequenceCache<PulseLayout>::getInstance().getOrCreate (
+            { sampleRate, seed, density, lengthSeconds * 1000.0f },
+            [&] { return generateDVNSequence (sampleRate, seed, density, lengthSeconds); });
+
+        const size_t numPulses = layout->pulses.size();
+        for (auto& t : tables)
+            t.coeffs.assign (numPulses, 0.0f);
+
+        prepareEngine (maxBlockSize, engine);
+
+        // Build the initial table synchronously
+        beginEnvelopeBuild();
+        advanceEnvelopeBuild (static_cast<int> (numPulses));
+        if (irPhase)
+        {
+            while (! tailConvolver.advanceImpulseResponseUpdate()) {}
+            finishTableSwap();
+        }
+
+        // The FFT engine only reads the prefix ring for the sparse head
+        ringSize = maxBlockSize + (fftEngine ? headLength : layout->length) + 16;
+        prefixRing.assign (static_cast<size_t> (2 * ringSize), 0.0);
+        runningSum = 0.0;
         writePos = 0;
     }
 
+    /**
+     * Returns immediately if the values match the active (or in-progress)
+     * table.  Otherwise advances the background table by one slice; a
+     * change made while a build is running is picked up after the swap.
+     */
     void setParameters (float decayShapePercent, float rt60Seconds)
     {
         decayShape = decayShapePercent * 0.01f;
         rt60 = rt60Seconds;
 
-        const double maxTailSec = std::min (3.0, std::max (0.1, static_cast<double> (rt60) * 2.0));
-        dvnLength = static_cast<int> (sr * maxTailSec);
+        if (! building)
+        {
+            const auto& active = tables[static_cast<size_t> (activeTable)];
+            if (decayShape == active.decayShape && rt60 == active.rt60)
+                return;
+
+            beginEnvelopeBuild();
+        }
 
-        updateEnvelopeCoefficients();
+        if (! irPhase)
+            advanceEnvelopeBuild (kEnvelopePulsesPerBlock);
+        else if (tailConvolver.advanceImpulseResponseUpdate())
+            finishTableSwap();
     }
 
+    bool isEnvelopeUpdatePending() const { return building; }
+    bool usesFFTEngine() const           { return fftEngine; }
+    int getNumPulses() const             { return layout != nullptr ? static_cast<int> (layout->pulses.size()) : 0; }
+    const PulseLayout* getLayout() const { return layout.get(); }
+
+    /**
+     * Every pulse is a boxcar of width w, so its output is
+     * coeff * (S[n - p] - S[n - p - w]) with S the running integral of the
+     * input.  S is kept in a mirrored ring (each value stored at i and
+     * i + ringSize), so both reads are contiguous spans with no wrapping.
+     * numSamples must not exceed the maxBlockSize given to prepare().
+     */
     void process (const float* input, float* output, int numSamples, float gain)
     {
-        const int ringSize = static_cast<int> (inputRingBuffer.size());
+        const int R = ringSize;
+        double* prefix = prefixRing.data();
 
+        const int blockStart = writePos;
+        int wp = writePos;
+        bool wrapped = false;
         for (int n = 0; n < numSamples; ++n)
         {
-            int idx = (writePos + n) % ringSize;
-            inputRingBuffer[static_cast<size_t> (idx)] = input[n];
+            runningSum += static_cast<double> (input[n]);
+            prefix[wp] = runningSum;
+            prefix[wp + R] = runningSum;
+            if (++wp == R)
+            {
+                wp = 0;
+                wrapped = true;
+            }
         }
+        writePos = wp;
 
-        std::fill (output, output + numSamples, 0.0f);
-
-        for (const auto& pulse : dvnPulses)
+        // Re-base once per lap: the differences read below are unchanged
+        // and S never holds more than about one ring's worth of input
+        if (wrapped)
         {
-            // Apply pre-computed normalised coefficient
-            const float coeff = pulse.sign * pulse.envelope * normGain;
-            if (std::abs (coeff) < 1.0e-8f)
-                continue;
+            const double base = runningSum;
+            for (auto& value : prefixRing)
+                value -= base;
+            runningSum = 0.0;
+        }
 
-            const int w = pulse.width;
-            const float scaledCoeff = coeff / static_cast<float> (w);
-            const int base = writePos - pulse.position;
+        std::fill (output, output + numSamples, 0.0f);
 
-            float windowSum = 0.0f;
-            for (int j = 0; j < w; ++j)
-            {
-                int idx = ((base - j) % ringSize + ringSize) % ringSize;
-                windowSum += inputRingBuffer[static_cast<size_t> (idx)];
-            }
+        // FFT engine: only the first partition is evaluated sparsely, with
+        // boxcars clipped at its end (the remainder is in the dense tail)
+        const auto& pulses = layout->pulses;
+        const auto& table = tables[static_cast<size_t> (activeTable)];
+        const auto& coeffs = table.coeffs;
+        const size_t numSparse = fftEngine ? numHeadPulses : pulses.size();
+        const int sparseEnd = fftEngine ? headLength : std::numeric_limits<int>::max();
 
-            output[0] += scaledCoeff * windowSum;
+        for (size_t k = 0; k < numSparse; ++k)
+        {
+            // Pre-computed coefficient, already divided by the width
+            if (coeffs[k] == 0.0f)
+                continue;
+            const float scaledCoeff = coeffs[k] * table.normGain;
+
+            const int position = tapPosition (pulses[k]);
+            const int width = std::min (pulses[k].width, sparseEnd - position);
+
+            int head = blockStart - position;
+            if (head < 0)
+                head += R;
+            int tail = head - width;
+            if (tail < 0)
+                tail += R;
+
+            const double* sHead = prefix + head;
+            const double* sTail = prefix + tail;
+            for (int n = 0; n < numSamples; ++n)
+                output[n] += scaledCoeff * static_cast<float> (sHead[n] - sTail[n]);
+        }
 
-            for (int n = 1; n < numSamples; ++n)
-            {
-                int addIdx = ((base + n) % ringSize + ringSize) % ringSize;
-                int remIdx = ((base + n - w) % ringSize + ringSize) % ringSize;
-                windowSum += inputRingBuffer[static_cast<size_t> (addIdx)];
-                windowSum -= inputRingBuffer[static_cast<size_t> (remIdx)];
-                output[n] += scaledCoeff * windowSum;
-            }
+        if (fftEngine)
+        {
+            float* dense = tailScratch.data();
+            tailConvolver.process (input, dense, numSamples);
+            for (int n = 0; n < numSamples; ++n)
+                output[n] += dense[n];
         }
 
         for (int n = 0; n < numSamples; ++n)
             output[n] *= gain;
-
-        writePos = (writePos + numSamples) % ringSize;
     }
 
     void reset()
     {
-        std::fill (inputRingBuffer.begin(), inputRingBuffer.end(), 0.0f);
+        std::fill (prefixRing.begin(), prefixRing.end(), 0.0);
+        runningSum = 0.0;
         writePos = 0;
+        tailConvolver.reset();
     }
 
 private:
-    struct DVNPulse
+    static std::shared_ptr<const PulseLayout> generateDVNSequence (double sampleRate, uint32_t seed,
+                                                                   float density, float lengthSeconds)
     {
-        int position;
-        float sign;
-        int width;
-        float envelope;
-    };
+        auto result = std::make_shared<PulseLayout>();
 
-    void generateDVNSequence (uint32_t seed)
-    {
-        const float density = 1800.0f;
-        const int gridSize = std::max (1, static_cast<int> (sr / density));
+        // Fractional grid: one pulse per cell of sampleRate / density samples
+        const double grid = std::max (1.0, sampleRate / static_cast<double> (density));
 
-        dvnLength = static_cast<int> (sr * 3.0);
-        int numPulses = dvnLength / gridSize;
-        numPulses = std::min (numPulses, 500);
+        result->length = static_cast<int> (sampleRate * static_cast<double> (lengthSeconds));
+        const int numPulses = static_cast<int> (static_cast<double> (result->length) / grid);
 
-        dvnPulses.clear();
-        dvnPulses.reserve (static_cast<size_t> (numPulses));
+        result->pulses.reserve (static_cast<size_t> (numPulses));
 
         uint32_t rng = seed;
         for (int m = 0; m < numPulses; ++m)
         {
+            const int cellStart = static_cast<int> (static_cast<double> (m) * grid);
+            const int cellEnd   = static_cast<int> (static_cast<double> (m + 1) * grid);
+            const auto cellSize = static_cast<uint32_t> (std::max (1, cellEnd - cellStart));
+
             rng = rng * 1664525u + 1013904223u;
-            int pos = m * gridSize + static_cast<int> (rng % static_cast<uint32_t> (gridSize));
+            int pos = cellStart + static_cast<int> (rng % cellSize);
 
             rng = rng * 1664525u + 1013904223u;
             float sign = (rng & 0x80000000u) ? -1.0f : 1.0f;
@@ -126,53 +294,188 @@ private:
             rng = rng * 1664525u + 1013904223u;
             int width = 1 + static_cast<int> (rng % 4u);
 
-            if (pos < dvnLength)
-                dvnPulses.push_back ({ pos, sign, width, 1.0f });
+            if (pos < result->length)
+                result->pulses.push_back ({ pos, sign, width });
         }
 
-        updateEnvelopeCoefficients();
+        return result;
     }
 
-    void updateEnvelopeCoefficients()
+    /** Per-pulse coefficients for one (decayShape, rt60) pair. */
+    struct EnvelopeTable
     {
-        if (dvnPulses.empty())
-            return;
+        std::vector<float> coeffs;       // sign * env / width
+        float normGain = 1.0f;           // unity RMS gain over the whole table
+        float decayShape = -1.0f;
+        float rt60 = -1.0f;
+    };
+
+    void beginEnvelopeBuild()
+    {
+        building = true;
+        buildPos = 0;
+        buildEnergy = 0.0f;
+        buildShape = decayShape;
+        buildRT60 = rt60;
+
+        const double maxTailSec = std::min (static_cast<double> (config.lengthSeconds),
+                                            std::max (0.1, static_cast<double> (rt60) * 2.0));
+        buildLength = static_cast<int> (sr * maxTailSec);
+    }
 
-        float tau1 = rt60 / 6.9078f;
-        float tau2 = rt60 * 1.5f / 6.9078f;
+    /**
+     * Computes envelopes for up to maxPulses more pulses into the back
+     * table (and, for the FFT engine, their taps into the dense tail);
+     * swaps tables when done.
+     */
+    void advanceEnvelopeBuild (int maxPulses)
+    {
+        const auto& pulses = layout->pulses;
+        const size_t end = std::min (pulses.size(), buildPos + static_cast<size_t> (maxPulses));
 
-        // First pass: compute envelopes and accumulate energy
-        float energySum = 0.0f;
-        for (auto& pulse : dvnPulses)
+        const float tau1 = buildRT60 / 6.9078f;
+        const float tau2 = buildRT60 * 1.5f / 6.9078f;
+
+        auto& back = tables[static_cast<size_t> (1 - activeTable)];
+        float* dense = fftEngine ? tailConvolver.getStagingBuffer() : nullptr;
+
+        for (size_t k = buildPos; k < end; ++k)
         {
-            if (pulse.position >= dvnLength)
+            if (pulses[k].position >= buildLength)
             {
-                pulse.envelope = 0.0f;
+                back.coeffs[k] = 0.0f;
                 continue;
             }
 
-            float t = static_cast<float> (pulse.position) / static_cast<float> (sr);
-            float env = (1.0f - decayShape) * std::exp (-t / (tau1 + 1.0e-6f))
-                      + decayShape * std::exp (-t / (tau2 + 1.0e-6f));
-            pulse.envelope = env;
-            energySum += env * env;
+            float t = static_cast<float> (pulses[k].position) / static_cast<float> (sr);
+            float env = (1.0f - buildShape) * std::exp (-t / (tau1 + 1.0e-6f))
+                      + buildShape * std::exp (-t / (tau2 + 1.0e-6f));
+            buildEnergy += env * env;
+
+            const float coeff = pulses[k].sign * env / static_cast<float> (pulses[k].width);
+            back.coeffs[k] = coeff;
+
+            // Boxcar taps at or beyond headLength belong to the dense tail
+            if (dense != nullptr)
+            {
+                const int position = tapPosition (pulses[k]);
+                const int first = std::max (position, headLength) - headLength;
+                const int last  = std::min (position + pulses[k].width - headLength, tailLength);
+                for (int i = first; i < last; ++i)
+                    dense[i] += coeff;
+            }
         }
+        buildPos = end;
+
+        if (buildPos < pulses.size())
+            return;
 
         // Normalise so the sparse filter has unity RMS gain
-        normGain = (energySum > 1.0e-12f)
-                 ? (1.0f / std::sqrt (energySum))
-                 : 1.0f;
+        back.normGain = (buildEnergy > 1.0e-12f)
+                      ? (1.0f / std::sqrt (buildEnergy))
+                      : 1.0f;
+        back.decayShape = buildShape;
+        back.rt60 = buildRT60;
+
+        if (! fftEngine)
+        {
+            finishTableSwap();
+            return;
+        }
+
+        // The dense tail must be transformed before head and tail swap together
+        tailConvolver.commitStagedImpulseResponse (tailLength, back.normGain);
+        irPhase = true;
+    }
+
+    /** Where a pulse is read from: envelopes still follow its layout position. */
+    int tapPosition (const LayoutPulse& pulse) const
+    {
+        return std::max (0, pulse.position - leadSamples);
+    }
+
+    void finishTableSwap()
+    {
+        activeTable = 1 - activeTable;
+        building = false;
+        irPhase = false;
+    }
+
+    /**
+     * Sparse cost is ~2 operations per pulse per sample; the FFT engine
+     * pays for the head pulses plus the partitioned convolution.
+     */
+    void prepareEngine (int maxBlockSize, Engine engine)
+    {
+        // Larger partitions keep the MAC count per sample low; the sparse
+        // head covers the extra latency either way
+        int partition = kMinFFTPartition;
+        while (partition < maxBlockSize)
+            partition *= 2;
+
+        headLength = partition;
+        tailLength = std::max (0, layout->length - leadSamples + 4 - headLength);
+
+        const auto& pulses = layout->pulses;
+        numHeadPulses = 0;
+        while (numHeadPulses < pulses.size() && tapPosition (pulses[numHeadPulses]) < headLength)
+            ++numHeadPulses;
+
+        const float sparseCost = 2.0f * static_cast<float> (pulses.size());
+        const float fftCost = 2.0f * static_cast<float> (numHeadPulses)
+                            + PartitionedConvolver::estimateCostPerSample (
+                                  partition, (tailLength + partition - 1) / partition);
+
+        fftEngine = tailLength > 0
+                 && (engine == Engine::fft
+                     || (engine == Engine::automatic && fftCost < sparseCost));
+        irPhase = false;
+
+        if (fftEngine)
+        {
+            tailConvolver.prepare (partition, tailLength);
+            tailScratch.assign (static_cast<size_t> (std::max (1, maxBlockSize)), 0.0f);
+        }
+        else
+        {
+            tailScratch.clear();
+        }
     }
 
     double sr = 44100.0;
+    Config config;
     float decayShape = 0.4f;
     float rt60 = 1.8f;
-    int dvnLength = 0;
-    float normGain = 1.0f;
 
-    std::vector<DVNPulse> dvnPulses;
-    std::vector<float> inputRingBuffer;
+    std::shared_ptr<const PulseLayout> layout;
+    int leadSamples = 0;
+
+    // Double-buffered envelope tables (process reads tables[activeTable])
+    std::array<EnvelopeTable, 2> tables;
+    int activeTable = 0;
+    bool building = false;
+    size_t buildPos = 0;
+    float buildEnergy = 0.0f;
+    float buildShape = 0.0f;
+    float buildRT60 = 0.0f;
+    int buildLength = 0;
+
+    // Running integral of the input, re-based every lap of the ring
+    // (see process()), so S[a] - S[b] keeps its precision however long
+    // the session and whatever the DC content
+    std::vector<double> prefixRing;      // mirrored, 2 x ringSize
+    double runningSum = 0.0;
+    int ringSize = 1;
     int writePos = 0;
+
+    // FFT engine: sparse head [0, headLength) + dense partitioned tail
+    bool fftEngine = false;
+    bool irPhase = false;
+    int headLength = 0;
+    int tailLength = 0;
+    size_t numHeadPulses = 0;
+    PartitionedConvolver tailConvolver;
+    std::vector<float> tailScratch;
 };
 
 }  // namespace DSP
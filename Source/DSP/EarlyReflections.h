@@ -1,6 +1,11 @@
 #pragma once
 
 #include "DSP/VelvetNoise.h"
+#include <array>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <algorithm>
 
 namespace DSP
 {
@@ -9,33 +14,330 @@ namespace DSP
  * OVN early reflections (Layer 1).
  * Sparse FIR preserves string instrument transients.
  * Linear processing: no oversampling required.
+ *
+ * Multi-channel engine: all channels share one OVN position grid (the
+ * first channel's sequence) and are decorrelated by their own pulse
+ * signs (one seed per channel).  Each tap therefore has a dense row of
+ * per-channel coefficients over an interleaved input ring: it reads one
+ * contiguous frame and every load feeds a MAC, so the input history is
+ * walked once per tap rather than once per channel.
+ *
+ * Pre-delay is folded into the tap offsets: the ring is long enough
+ * for the maximum pre-delay and taps are read at (position + preDelay).
+ * The pre-delayed feed for the FDN is a separate DSP::PreDelay.
+ * Pattern length / density changes are generated off the audio thread
+ * into the inactive tap table and swapped in at a block boundary; both
+ * table swaps and pre-delay changes are crossfaded.
  */
 class EarlyReflections
 {
 public:
+    static constexpr int   MAX_CHANNELS  = 8;
+    static constexpr float MAX_LENGTH_MS = 80.0f;
+    static constexpr float FADE_TIME_MS  = 20.0f;
+
     EarlyReflections() = default;
 
-    void prepare (double sampleRate, int maxBlockSize, uint32_t seed)
+    void prepare (double sampleRate, int maxBlockSize,
+                  const uint32_t* seeds, int numChannelsToUse,
+                  int maxPreDelaySamplesToUse,
+                  float lengthMs = 30.0f, float density = 2000.0f)
     {
-        juce::ignoreUnused (maxBlockSize);
         sr = sampleRate;
-        ovn.generate (sampleRate, 30.0f, 2000.0f, seed);
+        numChannels = std::clamp (numChannelsToUse, 1, MAX_CHANNELS);
+        blockCapacity = std::max (1, maxBlockSize);
+        maxPreDelaySamples = std::max (0, maxPreDelaySamplesToUse);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            channelSeeds[static_cast<size_t> (ch)] = seeds[ch];
+
+        const int maxLengthSamples = static_cast<int> (sampleRate * MAX_LENGTH_MS * 0.001f) + 1;
+        ringFrames = maxPreDelaySamples + maxLengthSamples + blockCapacity;
+        ring.assign (static_cast<size_t> (ringFrames * numChannels), 0.0f);
+
+        const auto scratchSize = static_cast<size_t> (blockCapacity * numChannels);
+        for (auto& a : tapAccum)
+            a.assign (scratchSize, 0.0f);
+
+        buildTable (tables[0], lengthMs, density);
+        tables[1] = tables[0];
+        frontTable.store (0);
+        swapPending.store (false);
+        latestLengthMs.store (lengthMs);
+        latestDensity.store (density);
+
+        fadeLength = std::max (1, static_cast<int> (sampleRate * FADE_TIME_MS * 0.001f));
+        fading = false;
+        fadePos = 0;
+        currentOffset = 0;
+        previousOffset = 0;
+        previousTable = 0;
+        snapOffset = true;
+        writeFrame = 0;
     }
 
-    void process (const float* input, float* output,
-                  int numSamples, float gain)
+    /**
+     * Builds a new pattern into the inactive table and queues it for the
+     * audio thread.  Message / background thread only (allocates).
+     * Returns false if the previous pattern has not been picked up yet.
+     */
+    bool generatePattern (float lengthMs, float density)
     {
-        ovn.convolve (input, output, numSamples, gain);
+        if (swapPending.load (std::memory_order_acquire))
+            return false;
+
+        const int back = 1 - frontTable.load (std::memory_order_relaxed);
+        buildTable (tables[static_cast<size_t> (back)], lengthMs, density);
+
+        latestLengthMs.store (lengthMs);
+        latestDensity.store (density);
+        swapPending.store (true, std::memory_order_release);
+        return true;
+    }
+
+    bool isPatternSwapPending() const { return swapPending.load (std::memory_order_acquire); }
+    float getLatestLengthMs() const   { return latestLengthMs.load(); }
+    float getLatestDensity() const    { return latestDensity.load(); }
+
+    /**
+     * @param inputs          numChannels input pointers
+     * @param outputs         numChannels ER outputs
+     * @param preDelaySamples integer offset added to every tap
+     */
+    void process (const float* const* inputs, float* const* outputs,
+                  int numSamples, float gain, int preDelaySamples)
+    {
+        const int N = numChannels;
+
+        // Interleave input into the ring (one frame per sample)
+        const int blockStart = writeFrame;
+        int wf = writeFrame;
+        for (int n = 0; n < numSamples; ++n)
+        {
+            float* frame = ring.data() + wf * N;
+            for (int ch = 0; ch < N; ++ch)
+                frame[ch] = inputs[ch][n];
+            if (++wf == ringFrames)
+                wf = 0;
+        }
+        writeFrame = wf;
+
+        beginFadeIfNeeded (std::clamp (preDelaySamples, 0, maxPreDelaySamples));
+
+        const auto& current = tables[static_cast<size_t> (frontTable.load (std::memory_order_relaxed))];
+        renderTaps (current, currentOffset, blockStart, tapAccum[0].data(), numSamples);
+
+        if (! fading)
+        {
+            deinterleave (tapAccum[0].data(), outputs, numSamples, gain);
+            return;
+        }
+
+        // Crossfade from the previous (table, offset) to the current one
+        const auto& previous = tables[static_cast<size_t> (previousTable)];
+        renderTaps (previous, previousOffset, blockStart, tapAccum[1].data(), numSamples);
+        deinterleaveFade (tapAccum[1].data(), tapAccum[0].data(), outputs, numSamples, gain);
+
+        fadePos += numSamples;
+        if (fadePos >= fadeLength)
+        {
+            fading = false;
+            if (previousTable != frontTable.load (std::memory_order_relaxed))
+                swapPending.store (false, std::memory_order_release);
+        }
     }
 
     void reset()
     {
-        // Ring buffer state lives inside VelvetNoise
+        std::fill (ring.begin(), ring.end(), 0.0f);
+        writeFrame = 0;
+
+        // Abandon any crossfade; a finished table swap releases the back table
+        if (fading && previousTable != frontTable.load (std::memory_order_relaxed))
+            swapPending.store (false, std::memory_order_release);
+        fading = false;
+        snapOffset = true;
+    }
+
+    int getNumChannels() const { return numChannels; }
+
+    /** The (shared) sequence behind a channel of the current pattern. */
+    const VelvetNoise::PulseSequence* getSequence (int channel) const
+    {
+        return tables[static_cast<size_t> (frontTable.load())].sequences[static_cast<size_t> (channel)].get();
+    }
+    int getNumTaps() const
+    {
+        return static_cast<int> (tables[static_cast<size_t> (frontTable.load())].positions.size());
     }
 
 private:
-    VelvetNoise ovn;
+    struct TapTable
+    {
+        std::vector<int> positions;
+        std::vector<float> coeffs;       // numTaps x numChannels, dense
+
+        // Holds the sequences while the table uses them: the cache only
+        // keeps weak references, so this is what makes them shared
+        std::array<std::shared_ptr<const VelvetNoise::PulseSequence>, MAX_CHANNELS> sequences;
+    };
+
+    void buildTable (TapTable& table, float lengthMs, float density)
+    {
+        lengthMs = std::clamp (lengthMs, 1.0f, MAX_LENGTH_MS);
+        density  = std::max (1.0f, density);
+
+        auto& sequences = table.sequences;
+        for (auto& sequence : sequences)
+            sequence.reset();
+        for (int ch = 0; ch < numChannels; ++ch)
+            sequences[static_cast<size_t> (ch)] = VelvetNoise::PulseSequence::getShared (
+                sr, lengthMs, density, channelSeeds[static_cast<size_t> (ch)]);
+
+        // Positions, envelope and gain from the first channel; every
+        // sequence of these parameters has one pulse per grid cell, so
+        // pulse k of each channel supplies that channel's sign
+        const auto& grid = *sequences[0];
+        const size_t numTaps = grid.pulses.size();
+        const auto N = static_cast<size_t> (numChannels);
+
+        table.positions.resize (numTaps);
+        table.coeffs.resize (numTaps * N);
+        for (size_t k = 0; k < numTaps; ++k)
+        {
+            table.positions[k] = grid.pulses[k].position;
+            const float magnitude = grid.envelopes[k] * grid.normGain;
+
+            for (size_t ch = 0; ch < N; ++ch)
+            {
+                const auto& own = sequences[ch]->pulses;
+                const float sign = k < own.size() ? own[k].sign : grid.pulses[k].sign;
+                table.coeffs[k * N + ch] = sign * magnitude;
+            }
+        }
+    }
+
+    void beginFadeIfNeeded (int targetOffset)
+    {
+        if (snapOffset)
+        {
+            currentOffset = targetOffset;
+            snapOffset = false;
+        }
+
+        if (fading)
+            return;
+
+        const int front = frontTable.load (std::memory_order_relaxed);
+        const bool tableChange = swapPending.load (std::memory_order_acquire);
+
+        if (! tableChange && targetOffset == currentOffset)
+            return;
+
+        previousTable  = front;
+        previousOffset = currentOffset;
+        if (tableChange)
+            frontTable.store (1 - front, std::memory_order_relaxed);
+        currentOffset = targetOffset;
+
+        fading = true;
+        fadePos = 0;
+    }
+
+    /** Frame index 'delay' samples before block sample 0. */
+    int frameAt (int blockStart, int delay) const
+    {
+        int f = blockStart - delay;
+        if (f < 0)
+            f += ringFrames;
+        return f;
+    }
+
+    void renderTaps (const TapTable& table, int offset, int blockStart,
+                     float* acc, int numSamples) const
+    {
+        const int N = numChannels;
+        std::fill (acc, acc + numSamples * N, 0.0f);
+
+        const size_t numTaps = table.positions.size();
+        for (size_t k = 0; k < numTaps; ++k)
+        {
+            const float* c = table.coeffs.data() + k * static_cast<size_t> (N);
+            int readFrame = frameAt (blockStart, table.positions[k] + offset);
+
+            // At most two contiguous spans per tap
+            int n = 0;
+            while (n < numSamples)
+            {
+                const int span = std::min (numSamples - n, ringFrames - readFrame);
+                const float* src = ring.data() + readFrame * N;
+                float* dst = acc + n * N;
+
+                for (int i = 0; i < span; ++i)
+                    for (int ch = 0; ch < N; ++ch)
+                        dst[i * N + ch] += c[ch] * src[i * N + ch];
+
+                n += span;
+                readFrame = 0;
+            }
+        }
+    }
+
+    void deinterleave (const float* acc, float* const* outputs, int numSamples, float gain) const
+    {
+        const int N = numChannels;
+        for (int ch = 0; ch < N; ++ch)
+        {
+            float* out = outputs[ch];
+            for (int n = 0; n < numSamples; ++n)
+                out[n] = gain * acc[n * N + ch];
+        }
+    }
+
+    void deinterleaveFade (const float* from, const float* to, float* const* outputs,
+                           int numSamples, float gain) const
+    {
+        const int N = numChannels;
+        const float step = 1.0f / static_cast<float> (fadeLength);
+        for (int ch = 0; ch < N; ++ch)
+        {
+            float* out = outputs[ch];
+            for (int n = 0; n < numSamples; ++n)
+            {
+                const float g = std::min (1.0f, static_cast<float> (fadePos + n + 1) * step);
+                const float a = from[n * N + ch];
+                out[n] = gain * (a + g * (to[n * N + ch] - a));
+            }
+        }
+    }
+
     double sr = 44100.0;
+    int numChannels = 2;
+    int blockCapacity = 512;
+    int maxPreDelaySamples = 0;
+    std::array<uint32_t, MAX_CHANNELS> channelSeeds {};
+
+    // Double-buffered tap tables: the audio thread reads tables[frontTable],
+    // generatePattern() writes the other one while swapPending is false.
+    std::array<TapTable, 2> tables;
+    std::atomic<int>   frontTable { 0 };
+    std::atomic<bool>  swapPending { false };
+    std::atomic<float> latestLengthMs { 30.0f };
+    std::atomic<float> latestDensity { 2000.0f };
+
+    // Crossfade state (audio thread only)
+    bool fading = false;
+    int fadeLength = 1;
+    int fadePos = 0;
+    int currentOffset = 0;
+    int previousOffset = 0;
+    int previousTable = 0;
+    bool snapOffset = true;
+
+    std::vector<float> ring;             // interleaved, ringFrames x numChannels
+    std::array<std::vector<float>, 2> tapAccum;
+    int ringFrames = 0;
+    int writeFrame = 0;
 };
 
 }  // namespace DSP
@@ -4,6 +4,8 @@
 #include "DSP/FeedbackMatrix.h"
 #include "DSP/AttenuationFilter.h"
 #include "DSP/Saturation.h"
+#include "DSP/SaturationOversampler.h"
+#include "DSP/FastMath.h"
 #include "DSP/SaturationToneFilter.h"
 #include "DSP/Diffuser.h"
 #include <array>
@@ -15,7 +17,8 @@ namespace DSP
 
 /**
  * 8-channel Feedback Delay Network with input diffuser (Layer 2).
- * Runs at oversampled rate.
+ * Runs at the oversampled rate, or at the base rate with only the
+ * nonlinear stages locally oversampled.
  *
  * v3 (2025): Internal one-pole smoothing on delay lengths and
  * attenuation coefficients to eliminate zipper noise when
@@ -31,6 +34,66 @@ public:
         887, 1151, 1559, 1907, 2467, 3109, 3907, 4787
     };
 
+    /**
+     * Input and output routing: gains[c][i] connects I/O channel c with
+     * delay line i, in both directions.  Applied as a small mat-vec per
+     * sample (unused rows are zero), so any panning of the inputs across
+     * the lines, and up to MAX_IO_CHANNELS outputs, cost the same.  The
+     * default interleaved stereo routing skips the mat-vec: one multiply
+     * per line in, one per line out.
+     */
+    static constexpr int MAX_IO_CHANNELS = 4;
+    using RoutingMatrix = std::array<std::array<float, NUM_CHANNELS>, MAX_IO_CHANNELS>;
+
+    /**
+     * Stereo: L on the even lines, R on the odd ones, read back the same way.
+     * MidSide: mid on the even lines, side on the odd ones, decoded to L/R.
+     * MonoIn: L + R into every line, stereo out.
+     */
+    enum class Routing { Stereo, MidSide, MonoIn };
+
+    /** Line i <-> I/O channel i % numIoChannels, at the given gain. */
+    static RoutingMatrix makeInterleavedRouting (int numIoChannels, float gain)
+    {
+        numIoChannels = std::clamp (numIoChannels, 1, MAX_IO_CHANNELS);
+        RoutingMatrix gains {};
+        for (int i = 0; i < NUM_CHANNELS; ++i)
+            gains[static_cast<size_t> (i % numIoChannels)][static_cast<size_t> (i)] = gain;
+        return gains;
+    }
+
+    static RoutingMatrix makeInputRouting (Routing routing)
+    {
+        constexpr float inputScale = 0.5f;
+        if (routing == Routing::Stereo)
+            return makeInterleavedRouting (2, inputScale);
+
+        RoutingMatrix gains {};
+        for (size_t i = 0; i < NUM_CHANNELS; ++i)
+        {
+            const float sideSign = (routing == Routing::MidSide && i % 2 == 1) ? -1.0f : 1.0f;
+            gains[0][i] = 0.5f * inputScale;
+            gains[1][i] = 0.5f * inputScale * sideSign;
+        }
+        return gains;
+    }
+
+    static RoutingMatrix makeOutputRouting (Routing routing)
+    {
+        constexpr float outputScale = 0.5f;
+        if (routing != Routing::MidSide)
+            return makeInterleavedRouting (2, outputScale);
+
+        // L = mid + side, R = mid - side
+        RoutingMatrix gains {};
+        for (size_t i = 0; i < NUM_CHANNELS; ++i)
+        {
+            gains[0][i] = outputScale;
+            gains[1][i] = i % 2 == 0 ? outputScale : -outputScale;
+        }
+        return gains;
+    }
+
     FDNReverb() = default;
 
     void prepare (double sampleRate, int maxBlockSize)
@@ -43,18 +106,22 @@ public:
         int maxDelay = static_cast<int> (4787 * 2.0 * (sampleRate / 44100.0)) + 128;
         for (int i = 0; i < NUM_CHANNELS; ++i)
             delayLines[i].prepare (maxDelay);
+        for (auto& dl : inputAlignment)
+            dl.prepare (kMaxSatLatency);
 
         for (auto& filter : attenuationFilters)
             filter.reset();
 
         for (auto& sat : saturators)
-            sat.prepare (sampleRate);
+            sat.prepare (sampleRate * saturationOversampler.getFactor());
 
         for (auto& tf : toneFilters)
             tf.prepare (sampleRate);
 
         diffuser.prepare (sampleRate, maxBlockSize);
 
+        stageFadeStep = 1.0f / std::max (1.0f, static_cast<float> (sr * kStageFadeSeconds));
+
         lfoPhase = 0.0;
         energyAccum = 0.0f;
         energySampleCount = 0;
@@ -117,19 +184,190 @@ public:
         currentModDepth = modDepth * 0.01f;
         currentModRate  = modRate;
         maxModSamples   = 16.0f;
+
+        updateStageTargets (false);
+    }
+
+    void setRouting (Routing routing)
+    {
+        setInputRouting (makeInputRouting (routing));
+        setOutputRouting (makeOutputRouting (routing));
+    }
+
+    void setInputRouting (const RoutingMatrix& gains)
+    {
+        inputGains = gains;
+        inputInterleaved = isInterleavedStereo (gains);
+    }
+
+    void setOutputRouting (const RoutingMatrix& gains)
+    {
+        outputGains = gains;
+        outputInterleaved = isInterleavedStereo (gains);
+    }
+
+    /** 0 = off, 1 = first-order ADAA, 2 = second-order ADAA (see Saturation). */
+    void setSaturationAntiAliasing (int mode)
+    {
+        for (auto& sat : saturators)
+            sat.setAntiAliasing (mode);
+    }
+
+    /**
+     * Local oversampling of the saturation stage and safety clamp alone:
+     * 0 = off, 1 = 2x ... 4 = 16x (see SaturationOversampler).  While the
+     * stage runs its halfband latency is taken off the delay lines and
+     * added to the input feed instead, so loop and onset timing both hold.
+     * A running stage is faded out first and back in at the new rate, so
+     * the filter and alignment state is never swapped under the signal.
+     */
+    void setSaturationOversampling (int numStages)
+    {
+        const int requested = pendingSatStages >= 0 ? pendingSatStages
+                                                    : saturationOversampler.getNumStages();
+        if (numStages == requested)
+            return;
+
+        // Back to the running setting before it faded out: just fade back in
+        pendingSatStages = numStages == saturationOversampler.getNumStages() ? -1 : numStages;
+
+        if (pendingSatStages >= 0 && stageMix[SatStage] <= 0.0f)
+            applySaturationOversampling();
+        else
+            updateStageTargets (false);
     }
 
     void processSample (float inputL, float inputR,
                         float& outputL, float& outputR)
     {
-        // --- 0. Input diffuser ---
-        constexpr float inputScale = 0.5f;
+        outputL = inputL;
+        outputR = inputR;
+        processBlock (&outputL, &outputR, 1);
+    }
+
+    void processBlock (float* left, float* right, int numSamples)
+    {
+        float* channels[2] = { left, right };
+        processBlock (channels, 2, numSamples);
+    }
+
+    /**
+     * Processes a block in place: up to MAX_IO_CHANNELS channels are
+     * routed in and the same channels are overwritten with the routed
+     * outputs.  The active stage combination
+     * (saturation, tone, attenuation, modulation) is resolved once per
+     * block to a kernel specialised at compile time, so inactive stages
+     * cost nothing.  While a stage is toggling, a generic kernel runs
+     * every stage and crossfades it in or out over kStageFadeSeconds.
+     */
+    void processBlock (float* const* channels, int numChannels, int numSamples)
+    {
+        IoBlock io;
+        io.numChannels = std::clamp (numChannels, 0, MAX_IO_CHANNELS);
+        for (int c = 0; c < io.numChannels; ++c)
+            io.channels[static_cast<size_t> (c)] = channels[c];
+
+        int done = 0;
+        while (done < numSamples)
+        {
+            // A new saturation oversampling takes over once the stage is out
+            if (pendingSatStages >= 0 && stageMix[SatStage] <= 0.0f)
+                applySaturationOversampling();
+
+            if (stageFadeRemaining > 0)
+            {
+                const int end = std::min (numSamples, done + stageFadeRemaining);
+                processBlockImpl<true, true, true, true, true> (io, done, end);
+                stageFadeRemaining -= end - done;
+                if (stageFadeRemaining == 0)
+                    stageMix = stageTarget;
+                done = end;
+                continue;
+            }
+
+            const int mask = (stageTarget[SatStage]   > 0.5f ? 1 : 0)
+                           | (stageTarget[ToneStage]  > 0.5f ? 2 : 0)
+                           | (stageTarget[AttenStage] > 0.5f ? 4 : 0)
+                           | (stageTarget[ModStage]   > 0.5f ? 8 : 0);
+            processStageKernel (mask, io, done, numSamples);
+            done = numSamples;
+        }
+    }
+
+    void reset()
+    {
+        if (pendingSatStages >= 0)
+            applySaturationOversampling();
+
+        for (auto& dl : delayLines)
+            dl.clear();
+        for (auto& dl : inputAlignment)
+            dl.clear();
+        for (auto& f : attenuationFilters)
+            f.reset();
+        for (auto& s : saturators)
+            s.reset();
+        for (auto& tf : toneFilters)
+            tf.reset();
+        diffuser.reset();
+        saturationOversampler.reset();
+        lfoPhase = 0.0;
+        energyAccum = 0.0f;
+        energySampleCount = 0;
 
-        std::array<float, NUM_CHANNELS> diffuserInput;
+        // Initialize smooth delays to target on reset
         for (int i = 0; i < NUM_CHANNELS; ++i)
+            currentDelays[i] = targetDelays[i];
+        currentSatLatency = targetSatLatency;
+
+        // No fade from whatever was running before
+        updateStageTargets (true);
+    }
+
+private:
+    using IoFrame = std::array<float, MAX_IO_CHANNELS>;
+
+    struct IoBlock
+    {
+        std::array<float*, MAX_IO_CHANNELS> channels {};
+        int numChannels = 0;
+    };
+
+    /** Samples [start, end) of io. */
+    template <bool Sat, bool Tone, bool Atten, bool Mod, bool Fade>
+    void processBlockImpl (const IoBlock& io, int start, int end)
+    {
+        for (int n = start; n < end; ++n)
+        {
+            if constexpr (Fade)
+                advanceStageFade();
+
+            IoFrame frame {};
+            for (int c = 0; c < io.numChannels; ++c)
+                frame[static_cast<size_t> (c)] = io.channels[static_cast<size_t> (c)][n];
+
+            processFrame<Sat, Tone, Atten, Mod, Fade> (frame, frame);
+
+            for (int c = 0; c < io.numChannels; ++c)
+                io.channels[static_cast<size_t> (c)][n] = frame[static_cast<size_t> (c)];
+        }
+    }
+
+    template <bool Sat, bool Tone, bool Atten, bool Mod, bool Fade>
+    void processFrame (const IoFrame& input, IoFrame& output)
+    {
+        // --- 0. Input routing + diffuser ---
+        std::array<float, NUM_CHANNELS> diffuserInput {};
+        if (inputInterleaved)
         {
-            float inputSample = (i % 2 == 0) ? inputL : inputR;
-            diffuserInput[i] = inputSample * inputScale;
+            for (size_t i = 0; i < NUM_CHANNELS; ++i)
+                diffuserInput[i] = inputGains[i % 2][i] * input[i % 2];
+        }
+        else
+        {
+            for (size_t c = 0; c < MAX_IO_CHANNELS; ++c)
+                for (size_t i = 0; i < NUM_CHANNELS; ++i)
+                    diffuserInput[i] += inputGains[c][i] * input[c];
         }
 
         std::array<float, NUM_CHANNELS> diffused;
@@ -140,6 +378,7 @@ public:
         {
             currentDelays[i] += smoothCoeff * (targetDelays[i] - currentDelays[i]);
         }
+        currentSatLatency += smoothCoeff * (targetSatLatency - currentSatLatency);
 
         // --- 2. Read delay lines ---
         std::array<float, NUM_CHANNELS> delayOutputs;
@@ -147,30 +386,34 @@ public:
             delayOutputs[i] = delayLines[i].read();
 
         // --- 3. Attenuation filter ---
-        std::array<float, NUM_CHANNELS> attenuated;
-        if (bypassAttenFilter)
-        {
-            attenuated = delayOutputs;
-        }
-        else
+        std::array<float, NUM_CHANNELS> attenuated = delayOutputs;
+        if constexpr (Atten)
         {
             for (int i = 0; i < NUM_CHANNELS; ++i)
                 attenuated[i] = attenuationFilters[i].process (delayOutputs[i]);
+
+            if constexpr (Fade)
+                crossfadeStage (delayOutputs, attenuated, stageMix[AttenStage]);
         }
 
-        // --- 4. Output tap ---
-        constexpr float outputScale = 0.5f;
-        outputL = 0.0f;
-        outputR = 0.0f;
-        for (int i = 0; i < NUM_CHANNELS; ++i)
+        // --- 4. Output routing ---
+        if (outputInterleaved)
         {
-            if (i % 2 == 0)
-                outputL += attenuated[i];
-            else
-                outputR += attenuated[i];
+            // Same summation order as the mat-vec, minus the zero terms
+            output = {};
+            for (size_t i = 0; i < NUM_CHANNELS; ++i)
+                output[i % 2] += outputGains[i % 2][i] * attenuated[i];
+        }
+        else
+        {
+            for (size_t c = 0; c < MAX_IO_CHANNELS; ++c)
+            {
+                float sum = 0.0f;
+                for (size_t i = 0; i < NUM_CHANNELS; ++i)
+                    sum += outputGains[c][i] * attenuated[i];
+                output[c] = sum;
+            }
         }
-        outputL *= outputScale;
-        outputR *= outputScale;
 
         // --- 5. Feedback matrix ---
         std::array<float, NUM_CHANNELS> feedback;
@@ -208,51 +451,69 @@ public:
         }
 
         // --- 6. Saturation ---
-        std::array<float, NUM_CHANNELS> afterSat;
-        if (bypassSaturation)
+        std::array<float, NUM_CHANNELS> afterSat = feedback;
+        if constexpr (Sat)
         {
-            afterSat = feedback;
-        }
-        else
-        {
-            for (int i = 0; i < NUM_CHANNELS; ++i)
-                afterSat[i] = saturators[i].process (feedback[i]);
+            if (saturationOversampler.getNumStages() > 0)
+                saturationOversampler.processFrame (saturators, feedback, afterSat, softLimit);
+            else
+                Saturation::processFrame (saturators, feedback, afterSat);
+
+            if constexpr (Fade)
+                crossfadeStage (feedback, afterSat, stageMix[SatStage]);
         }
 
         // --- 7. Tone filter ---
-        std::array<float, NUM_CHANNELS> processed;
-        if (bypassToneFilter)
-        {
-            processed = afterSat;
-        }
-        else
+        std::array<float, NUM_CHANNELS> processed = afterSat;
+        if constexpr (Tone)
         {
             for (int i = 0; i < NUM_CHANNELS; ++i)
                 processed[i] = toneFilters[i].process (afterSat[i]);
+
+            if constexpr (Fade)
+                crossfadeStage (afterSat, processed, stageMix[ToneStage]);
         }
 
         // --- 8. Safety limiter: per-channel soft clamp ---
+        // (With local oversampling it already ran at the high rate after
+        // the saturator; this pass only catches tone filter overshoot.)
         for (int i = 0; i < NUM_CHANNELS; ++i)
-        {
-            float x = processed[i];
-            if (x > 2.0f)       x = 2.0f * std::tanh (x * 0.5f);
-            else if (x < -2.0f) x = 2.0f * std::tanh (x * 0.5f);
-            processed[i] = x;
-        }
+            processed[i] = softLimit (processed[i]);
 
         // --- 9. Modulation + write ---
-        float lfoInc = 2.0f * 3.14159265f * currentModRate
-                     / static_cast<float> (sr);
+        float modScale = currentModDepth * maxModSamples;
+        if constexpr (Fade)
+            modScale *= stageMix[ModStage];
+
+        // The oversampled saturation stage delays the feedback: shorten
+        // the lines by that much and delay the input feed to match
+        float satLatency = 0.0f;
+        if constexpr (Sat)
+        {
+            satLatency = currentSatLatency;
+            if constexpr (Fade)
+                satLatency *= stageMix[SatStage];
+
+            if (satLatency > 0.0f)
+            {
+                for (int i = 0; i < NUM_CHANNELS; ++i)
+                {
+                    inputAlignment[i].setDelay (satLatency);
+                    inputAlignment[i].write (diffused[i]);
+                    diffused[i] = inputAlignment[i].read();
+                }
+            }
+        }
 
         for (int i = 0; i < NUM_CHANNELS; ++i)
         {
-            float delayToSet = currentDelays[i];
+            float delayToSet = currentDelays[i] - satLatency;
 
-            if (!bypassModulation)
+            if constexpr (Mod)
             {
                 float phaseOffset = 2.0f * 3.14159265f * static_cast<float> (i)
                                   / static_cast<float> (NUM_CHANNELS);
-                float mod = currentModDepth * maxModSamples
+                float mod = modScale
                           * std::sin (static_cast<float> (lfoPhase) + phaseOffset);
                 delayToSet += mod;
             }
@@ -261,45 +522,113 @@ public:
             delayLines[i].write (diffused[i] + processed[i]);
         }
 
-        if (!bypassModulation)
+        if constexpr (Mod)
         {
+            float lfoInc = 2.0f * 3.14159265f * currentModRate
+                         / static_cast<float> (sr);
             lfoPhase += static_cast<double> (lfoInc);
             if (lfoPhase > 2.0 * 3.14159265358979323846)
                 lfoPhase -= 2.0 * 3.14159265358979323846;
         }
+    }
+
+    /** Moves each stage mix one sample toward its target (fade kernel only). */
+    void advanceStageFade()
+    {
+        for (size_t s = 0; s < stageMix.size(); ++s)
+        {
+            if (stageMix[s] < stageTarget[s])
+                stageMix[s] = std::min (stageTarget[s], stageMix[s] + stageFadeStep);
+            else if (stageMix[s] > stageTarget[s])
+                stageMix[s] = std::max (stageTarget[s], stageMix[s] - stageFadeStep);
+        }
+    }
 
-        // --- 10. Denormal kill on outputs ---
-        outputL = killDenormal (outputL);
-        outputR = killDenormal (outputR);
+    static void crossfadeStage (const std::array<float, NUM_CHANNELS>& bypassed,
+                                std::array<float, NUM_CHANNELS>& processed, float mix)
+    {
+        for (int i = 0; i < NUM_CHANNELS; ++i)
+            processed[i] = bypassed[i] + mix * (processed[i] - bypassed[i]);
     }
 
-    void reset()
+    /**
+     * Swaps in the pending saturation oversampling while the stage is
+     * silent (faded out or inactive): nothing in the loop depends on its
+     * filter, alignment or latency state until it fades back in.
+     */
+    void applySaturationOversampling()
     {
-        for (auto& dl : delayLines)
+        saturationOversampler.prepare (pendingSatStages);
+        pendingSatStages = -1;
+
+        for (auto& sat : saturators)
+            sat.prepare (sr * saturationOversampler.getFactor());
+        for (auto& dl : inputAlignment)
             dl.clear();
-        for (auto& f : attenuationFilters)
-            f.reset();
-        for (auto& s : saturators)
-            s.reset();
-        for (auto& tf : toneFilters)
-            tf.reset();
-        diffuser.reset();
-        lfoPhase = 0.0;
-        energyAccum = 0.0f;
-        energySampleCount = 0;
+        targetSatLatency = saturationOversampler.getLatency();
+        currentSatLatency = targetSatLatency;
 
-        // Initialize smooth delays to target on reset
-        for (int i = 0; i < NUM_CHANNELS; ++i)
-            currentDelays[i] = targetDelays[i];
+        updateStageTargets (false);
     }
 
-private:
-    static float killDenormal (float x)
+    /**
+     * Which stages run, from the bypass switches and the current settings.
+     * A change starts a crossfade; snap skips it (prepare / reset).  The
+     * saturation stage is held out while a new oversampling is pending.
+     */
+    void updateStageTargets (bool snap)
     {
-        static constexpr float antiDenormal = 1.0e-18f;
-        x += antiDenormal;
-        x -= antiDenormal;
-        return x;
+        std::array<float, NUM_STAGES> target {};
+        target[SatStage]   = (! bypassSaturation  && saturators[0].isActive()
+                              && pendingSatStages < 0) ? 1.0f : 0.0f;
+        target[ToneStage]  = (! bypassToneFilter  && toneFilters[0].isEnabled()) ? 1.0f : 0.0f;
+        target[AttenStage] = (! bypassAttenFilter) ? 1.0f : 0.0f;
+        target[ModStage]   = (! bypassModulation  && currentModDepth > 0.0f) ? 1.0f : 0.0f;
+
+        if (snap)
+        {
+            stageTarget = target;
+            stageMix = target;
+            stageFadeRemaining = 0;
+        }
+        else if (target != stageTarget)
+        {
+            stageTarget = target;
+            stageFadeRemaining = std::max (1, static_cast<int> (sr * kStageFadeSeconds));
+        }
+    }
+
+    /** Runs the steady-state kernel for a stage mask (sat = 1, tone = 2, atten = 4, mod = 8). */
+    template <int Mask = 0>
+    void processStageKernel (int mask, const IoBlock& io, int start, int end)
+    {
+        if constexpr (Mask < 15)
+        {
+            if (mask != Mask)
+            {
+                processStageKernel<Mask + 1> (mask, io, start, end);
+                return;
+            }
+        }
+
+        processBlockImpl<(Mask & 1) != 0, (Mask & 2) != 0,
+                         (Mask & 4) != 0, (Mask & 8) != 0, false> (io, start, end);
+    }
+
+    /** Soft clamp above |x| = 2, transparent below. */
+    /** Even lines on channel 0, odd lines on channel 1, rows 2+ empty. */
+    static bool isInterleavedStereo (const RoutingMatrix& gains)
+    {
+        for (size_t c = 0; c < MAX_IO_CHANNELS; ++c)
+            for (size_t i = 0; i < NUM_CHANNELS; ++i)
+                if (c != i % 2 && gains[c][i] != 0.0f)
+                    return false;
+        return true;
+    }
+
+    static float softLimit (float x)
+    {
+        return std::abs (x) > 2.0f ? 2.0f * FastMath::tanh (x * 0.5f) : x;
     }
 
     double sr = 44100.0;
@@ -309,11 +638,21 @@ private:
     FeedbackMatrix feedbackMatrix;
     std::array<AttenuationFilter, NUM_CHANNELS> attenuationFilters;
     std::array<Saturation, NUM_CHANNELS> saturators;
+    SaturationOversampler<NUM_CHANNELS> saturationOversampler;
+    std::array<DelayLine, NUM_CHANNELS> inputAlignment;   // input delay matching the stage
+    static constexpr int kMaxSatLatency = 64;
     std::array<SaturationToneFilter, NUM_CHANNELS> toneFilters;
     Diffuser diffuser;
+    RoutingMatrix inputGains  = makeInputRouting (Routing::Stereo);
+    RoutingMatrix outputGains = makeOutputRouting (Routing::Stereo);
+    bool inputInterleaved  = true;      // inputGains / outputGains skip the mat-vec
+    bool outputInterleaved = true;
 
     std::array<float, NUM_CHANNELS> targetDelays {};
     std::array<float, NUM_CHANNELS> currentDelays {};
+    int pendingSatStages = -1;              // setSaturationOversampling, -1 = none
+    float targetSatLatency  = 0.0f;
+    float currentSatLatency = 0.0f;
     float currentModDepth  = 0.0f;
     float currentModRate   = 0.5f;
     float maxModSamples    = 16.0f;
@@ -328,6 +667,14 @@ private:
     bool bypassToneFilter  = false;
     bool bypassAttenFilter = false;
     bool bypassModulation  = false;
+
+    // Stage switching (see processBlock)
+    static constexpr double kStageFadeSeconds = 0.01;
+    enum Stage { SatStage = 0, ToneStage, AttenStage, ModStage, NUM_STAGES };
+    std::array<float, NUM_STAGES> stageMix    { 0.0f, 0.0f, 1.0f, 0.0f };
+    std::array<float, NUM_STAGES> stageTarget { 0.0f, 0.0f, 1.0f, 0.0f };
+    int stageFadeRemaining = 0;
+    float stageFadeStep = 1.0f;
 };
 
 }  // namespace DSP
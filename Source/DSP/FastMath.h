@@ -0,0 +1,32 @@
+#pragma once
+
+#include <algorithm>
+
+namespace DSP
+{
+namespace FastMath
+{
+
+/**
+ * [7/6] Padé approximant of tanh, clamped where it reaches 1.
+ *
+ *     tanh(x) ~ x (135135 + 17325 x^2 + 378 x^4 + x^6)
+ *             / (135135 + 62370 x^2 + 3150 x^4 + 28 x^6)
+ *
+ * Odd, monotonic on the clamped range and bounded to [-1, 1].  Absolute
+ * error against std::tanh is below 1.0e-4 over the whole real line
+ * (worst case ~9.6e-5 at the clamp point, < 1.0e-6 for |x| < 2).
+ * Branch-free apart from the clamp, so loops over it vectorise.
+ */
+inline float tanh (float x)
+{
+    constexpr float clampPoint = 4.97178686f;
+    x = std::clamp (x, -clampPoint, clampPoint);
+    const float x2 = x * x;
+    const float num = x * (135135.0f + x2 * (17325.0f + x2 * (378.0f + x2)));
+    const float den = 135135.0f + x2 * (62370.0f + x2 * (3150.0f + x2 * 28.0f));
+    return num / den;
+}
+
+}  // namespace FastMath
+}  // namespace DSP
@@ -0,0 +1,2 @@
+#include "DSP/HalfbandResampler.h"
+// Implementation is in the header.
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <algorithm>
+
+namespace DSP
+{
+
+/**
+ * Linear-phase halfband FIR (Blackman-windowed sinc, cutoff fs/4).
+ *
+ * A halfband filter is zero at every even offset from the centre except
+ * the centre itself.  With NUM_TAPS = 4K - 1 the centre sits at an odd
+ * index, so every odd-indexed tap but the centre is zero: the odd
+ * polyphase branch is a pure delay of 0.5 and only the K*2 even taps
+ * need multiplies.
+ *
+ * The transition band narrows with the length: 47 taps keep a base-rate
+ * signal flat to ~0.38 fs, while inner stages of a cascade, whose signal
+ * only fills the bottom quarter of their band, get away with 23.
+ */
+template <int NumTaps>
+struct HalfbandDesign
+{
+    static_assert ((NumTaps + 1) % 4 == 0, "Halfband length must be 4K - 1");
+
+    static constexpr int NUM_TAPS   = NumTaps;
+    static constexpr int CENTRE     = (NUM_TAPS - 1) / 2;   // odd
+    static constexpr int NUM_EVEN   = (NUM_TAPS + 1) / 2;   // taps 0, 2, ..., NUM_TAPS - 1
+
+    /** Group delay of one decimate or interpolate stage, in full-rate samples. */
+    static constexpr int LATENCY = CENTRE;
+
+    std::array<float, NUM_EVEN> even {};   // h[2j]
+
+    HalfbandDesign()
+    {
+        const double pi = 3.14159265358979323846;
+        double sum = 0.0;
+
+        for (int j = 0; j < NUM_EVEN; ++j)
+        {
+            const int n = 2 * j;
+            const double x = static_cast<double> (n - CENTRE);
+            const double sinc = std::sin (0.5 * pi * x) / (pi * x);
+            const double w = 0.42
+                           - 0.5  * std::cos (2.0 * pi * n / (NUM_TAPS - 1))
+                           + 0.08 * std::cos (4.0 * pi * n / (NUM_TAPS - 1));
+            even[static_cast<size_t> (j)] = static_cast<float> (sinc * w);
+            sum += sinc * w;
+        }
+
+        // Even branch sums to exactly 0.5 so both branches have unity DC gain
+        for (auto& h : even)
+            h = static_cast<float> (h * 0.5 / sum);
+    }
+
+    static const HalfbandDesign& get()
+    {
+        static const HalfbandDesign coefficients;
+        return coefficients;
+    }
+};
+
+using HalfbandCoefficients      = HalfbandDesign<47>;
+using ShortHalfbandCoefficients = HalfbandDesign<23>;
+
+/**
+ * 2:1 polyphase halfband decimator.
+ * Keeps its phase across calls, so any block size works: an output is
+ * produced for every input sample at an even global index.
+ */
+template <typename Coefficients>
+class BasicHalfbandDecimator
+{
+public:
+    static constexpr int HISTORY = Coefficients::NUM_TAPS;
+
+    void reset()
+    {
+        history.fill (0.0f);
+        writePos = 0;
+        phase = 0;
+    }
+
+    /** Returns the number of outputs written (numSamples / 2, rounded by phase). */
+    int process (const float* input, int numSamples, float* output)
+    {
+        const auto& h = Coefficients::get().even;
+        int numOut = 0;
+
+        for (int n = 0; n < numSamples; ++n)
+        {
+            // Mirrored history: the last HISTORY samples are contiguous
+            history[static_cast<size_t> (writePos)] = input[n];
+            history[static_cast<size_t> (writePos + HISTORY)] = input[n];
+            if (++writePos == HISTORY)
+                writePos = 0;
+
+            if (phase == 0)
+            {
+                // newest sample at x[HISTORY - 1], x[HISTORY - 1 - k] = input[t - k]
+                const float* x = history.data() + writePos;
+                float acc = 0.5f * x[HISTORY - 1 - Coefficients::CENTRE];
+                for (int j = 0; j < Coefficients::NUM_EVEN; ++j)
+                    acc += h[static_cast<size_t> (j)] * x[HISTORY - 1 - 2 * j];
+                output[numOut++] = acc;
+            }
+
+            phase ^= 1;
+        }
+
+        return numOut;
+    }
+
+private:
+    std::array<float, 2 * HISTORY> history {};
+    int writePos = 0;
+    int phase = 0;
+};
+
+/**
+ * 1:2 polyphase halfband interpolator, the counterpart of
+ * BasicHalfbandDecimator.  Driven with the same block sizes, it consumes
+ * exactly the samples the decimator produced.
+ */
+template <typename Coefficients>
+class BasicHalfbandInterpolator
+{
+public:
+    static constexpr int HISTORY = Coefficients::NUM_EVEN;
+
+    void reset()
+    {
+        history.fill (0.0f);
+        writePos = 0;
+        phase = 0;
+    }
+
+    /** Writes numSamples full-rate outputs, reading one input per even output. */
+    void process (const float* input, float* output, int numSamples)
+    {
+        const auto& h = Coefficients::get().even;
+        int in = 0;
+
+        for (int n = 0; n < numSamples; ++n)
+        {
+            if (phase == 0)
+            {
+                history[static_cast<size_t> (writePos)] = input[in];
+                history[static_cast<size_t> (writePos + HISTORY)] = input[in];
+                ++in;
+                if (++writePos == HISTORY)
+                    writePos = 0;
+
+                // Even branch (zero-stuffed gain of 2 folded in)
+                const float* y = history.data() + writePos;
+                float acc = 0.0f;
+                for (int j = 0; j < Coefficients::NUM_EVEN; ++j)
+                    acc += h[static_cast<size_t> (j)] * y[HISTORY - 1 - j];
+                output[n] = 2.0f * acc;
+            }
+            else
+            {
+                // Odd branch: centre tap only, 2 * 0.5 = pure delay
+                const float* y = history.data() + writePos;
+                output[n] = y[HISTORY - 1 - (Coefficients::CENTRE - 1) / 2];
+            }
+
+            phase ^= 1;
+        }
+    }
+
+private:
+    std::array<float, 2 * HISTORY> history {};
+    int writePos = 0;
+    int phase = 0;
+};
+
+using HalfbandDecimator        = BasicHalfbandDecimator<HalfbandCoefficients>;
+using HalfbandInterpolator     = BasicHalfbandInterpolator<HalfbandCoefficients>;
+using ShortHalfbandDecimator   = BasicHalfbandDecimator<ShortHalfbandCoefficients>;
+using ShortHalfbandInterpolator = BasicHalfbandInterpolator<ShortHalfbandCoefficients>;
+
+}  // namespace DSP
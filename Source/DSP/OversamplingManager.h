@@ -13,26 +13,36 @@ namespace DSP
 class OversamplingManager
 {
 public:
+    /**
+     * ハーフバンドフィルタの種類（レイテンシ／品質のトレードオフ）。
+     * LowLatencyIIR はトラッキング向け、LinearPhaseFIR はミックスダウン向け。
+     */
+    enum class Filter
+    {
+        LowLatencyIIR,    // IIR, maxQuality = false
+        IIR,              // IIR, maxQuality = true（従来の既定値）
+        LinearPhaseFIR    // FIR イコリップル、直線位相
+    };
+    static constexpr int kNumFilters = 3;
+
     OversamplingManager() = default;
 
     /**
      * @param numChannels チャンネル数
-     * @param factor 0=Off(1x), 1=2x, 2=4x
+     * @param factor 0=Off(1x), 1=2x, 2=4x, 3=8x, 4=16x（2 のべき乗のみ）
+     * @param filterToUse ハーフバンドフィルタの種類
      */
-    void prepare (int numChannels, int factor, double sampleRate, int maxBlockSize)
+    void prepare (int numChannels, int factor, double sampleRate, int maxBlockSize,
+                  Filter filterToUse = Filter::IIR)
     {
         juce::ignoreUnused (sampleRate);
         currentFactor = factor;
         channels = numChannels;
+        filter = filterToUse;
 
         if (factor > 0)
         {
-            oversampler = std::make_unique<juce::dsp::Oversampling<float>> (
-                numChannels,
-                factor,
-                juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR,
-                true  // maxQuality
-            );
+            oversampler = createOversampler (numChannels, factor, filter);
             oversampler->initProcessing (static_cast<size_t> (maxBlockSize));
         }
         else
@@ -41,6 +51,17 @@ public:
         }
     }
 
+    /**
+     * prepare() せずにレイテンシだけを求める（処理バッファは確保しない）。
+     * 未構築のパスの遅延補償を事前に計算するために使う。
+     */
+    static float computeLatencyInSamples (int numChannels, int factor, Filter filterToUse)
+    {
+        if (factor <= 0)
+            return 0.0f;
+        return createOversampler (numChannels, factor, filterToUse)->getLatencyInSamples();
+    }
+
     juce::dsp::AudioBlock<float> processSamplesUp (juce::dsp::AudioBlock<float>& inputBlock)
     {
         if (oversampler != nullptr)
@@ -69,6 +90,7 @@ public:
     }
 
     int getFactor() const { return currentFactor; }
+    Filter getFilter() const { return filter; }
 
     void reset()
     {
@@ -77,9 +99,24 @@ public:
     }
 
 private:
+    static std::unique_ptr<juce::dsp::Oversampling<float>> createOversampler (int numChannels, int factor,
+                                                                              Filter filterToUse)
+    {
+        const bool fir = filterToUse == Filter::LinearPhaseFIR;
+        return std::make_unique<juce::dsp::Oversampling<float>> (
+            numChannels,
+            factor,
+            fir ? juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple
+                : juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR,
+            filterToUse != Filter::LowLatencyIIR,  // maxQuality
+            fir                                    // integer latency (FIR のみ)
+        );
+    }
+
     std::unique_ptr<juce::dsp::Oversampling<float>> oversampler;
     int currentFactor = 1;
     int channels = 2;
+    Filter filter = Filter::IIR;
 };
 
 }  // namespace DSP
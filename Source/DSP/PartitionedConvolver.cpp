@@ -0,0 +1,2 @@
+#include "DSP/PartitionedConvolver.h"
+// Implementation is in the header.
@@ -0,0 +1,286 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+
+namespace DSP
+{
+
+/**
+ * Uniformly partitioned overlap-save FFT convolver (juce::dsp::FFT).
+ *
+ * The impulse response is split into partitions of B samples, each
+ * transformed once; every B input samples one forward FFT, P complex
+ * multiply-accumulates against a frequency-domain delay line and one
+ * inverse FFT produce the next B output samples.  Input is buffered
+ * internally, so process() accepts any block size and the output has a
+ * fixed latency of exactly B samples.
+ *
+ * Partition spectra are double-buffered: loadImpulseResponse() stages a
+ * new IR, advanceImpulseResponseUpdate() transforms a few partitions per
+ * call, and the new set is swapped in at a block boundary once complete.
+ * A caller that builds its IR piecewise can write straight into the
+ * staging buffer (zero between updates) and commit it with a gain, so
+ * neither the copy nor the scaling ever touches the whole IR at once.
+ * All buffers are sized in prepare(); nothing here allocates afterwards.
+ */
+class PartitionedConvolver
+{
+public:
+    /** IR samples transformed per advanceImpulseResponseUpdate() call by default. */
+    static constexpr int kUpdateSamplesPerCall = 16384;
+
+    PartitionedConvolver() = default;
+
+    /** partitionSize is rounded up to a power of two. */
+    void prepare (int partitionSize, int maxImpulseLength)
+    {
+        int order = 1;
+        while ((1 << order) < std::max (2, partitionSize))
+            ++order;
+
+        B = 1 << order;
+        fftSize = 2 * B;
+        fft = std::make_unique<juce::dsp::FFT> (order + 1);
+
+        numBins = B + 1;
+        maxPartitions = std::max (1, (std::max (1, maxImpulseLength) + B - 1) / B);
+        maxIRLength = maxPartitions * B;
+
+        const auto spectrumSize = static_cast<size_t> (2 * numBins);
+        for (auto& h : partitionSpectra)
+            h.assign (spectrumSize * static_cast<size_t> (maxPartitions), 0.0f);
+        delayLine.assign (spectrumSize * static_cast<size_t> (maxPartitions), 0.0f);
+        accumulator.assign (spectrumSize, 0.0f);
+        fftBuffer.assign (static_cast<size_t> (2 * fftSize), 0.0f);
+        pendingIR.assign (static_cast<size_t> (maxIRLength), 0.0f);
+
+        inputHistory.assign (static_cast<size_t> (fftSize), 0.0f);
+        outputBlock.assign (static_cast<size_t> (B), 0.0f);
+
+        activeSpectra = 0;
+        numActivePartitions = 0;
+        updating = false;
+        reset();
+    }
+
+    void reset()
+    {
+        std::fill (delayLine.begin(), delayLine.end(), 0.0f);
+        std::fill (inputHistory.begin(), inputHistory.end(), 0.0f);
+        std::fill (outputBlock.begin(), outputBlock.end(), 0.0f);
+        inputPos = 0;
+        delayLinePos = 0;
+    }
+
+    /**
+     * Stages a new impulse response (truncated to the prepared maximum).
+     * The previous IR stays active until the update has been advanced to
+     * completion.
+     */
+    void loadImpulseResponse (const float* ir, int length)
+    {
+        float* staging = getStagingBuffer();
+        std::copy (ir, ir + std::clamp (length, 0, maxIRLength), staging);
+        commitStagedImpulseResponse (length);
+    }
+
+    /**
+     * The staging buffer, getMaxImpulseLength() samples.  It is all zero
+     * whenever no update is pending: each partition is cleared as it is
+     * transformed.
+     */
+    float* getStagingBuffer()
+    {
+        if (updating)
+        {
+            // Restarting a half-done update: clear what it has not consumed
+            std::fill (pendingIR.begin() + updatePartition * B, pendingIR.begin() + pendingLength, 0.0f);
+            updating = false;
+        }
+        return pendingIR.data();
+    }
+
+    int getMaxImpulseLength() const { return maxIRLength; }
+
+    /** Stages the first length samples of the staging buffer, scaled by gain. */
+    void commitStagedImpulseResponse (int length, float gain = 1.0f)
+    {
+        pendingLength = std::clamp (length, 0, maxIRLength);
+        pendingGain = gain;
+        pendingPartitions = (pendingLength + B - 1) / B;
+        updatePartition = 0;
+        updating = true;
+    }
+
+    /**
+     * Transforms up to maxPartitionsToDo staged partitions (by default
+     * kUpdateSamplesPerCall worth); returns true once swapped in.
+     */
+    bool advanceImpulseResponseUpdate (int maxPartitionsToDo = 0)
+    {
+        if (! updating)
+            return true;
+
+        if (maxPartitionsToDo <= 0)
+            maxPartitionsToDo = std::max (1, kUpdateSamplesPerCall / B);
+
+        auto& back = partitionSpectra[static_cast<size_t> (1 - activeSpectra)];
+        const int end = std::min (pendingPartitions, updatePartition + maxPartitionsToDo);
+        const size_t spectrumSize = static_cast<size_t> (2 * numBins);
+
+        for (int p = updatePartition; p < end; ++p)
+        {
+            const int start = p * B;
+            const int count = std::min (B, pendingLength - start);
+
+            std::fill (fftBuffer.begin(), fftBuffer.end(), 0.0f);
+            float* staged = pendingIR.data() + start;
+            for (int i = 0; i < count; ++i)
+                fftBuffer[static_cast<size_t> (i)] = staged[i] * pendingGain;
+            std::fill (staged, staged + count, 0.0f);
+            fft->performRealOnlyForwardTransform (fftBuffer.data(), true);
+            std::copy (fftBuffer.begin(), fftBuffer.begin() + static_cast<std::ptrdiff_t> (spectrumSize),
+                       back.begin() + static_cast<std::ptrdiff_t> (spectrumSize * static_cast<size_t> (p)));
+        }
+        updatePartition = end;
+
+        if (updatePartition < pendingPartitions)
+            return false;
+
+        activeSpectra = 1 - activeSpectra;
+        numActivePartitions = pendingPartitions;
+        updating = false;
+        return true;
+    }
+
+    /** Loads and fully transforms an IR immediately (prepare-time use). */
+    void setImpulseResponse (const float* ir, int length)
+    {
+        loadImpulseResponse (ir, length);
+        advanceImpulseResponseUpdate (maxPartitions);
+    }
+
+    bool isUpdatePending() const { return updating; }
+
+    /** Convolves numSamples (any count); output lags the input by getLatency() samples. */
+    void process (const float* input, float* output, int numSamples)
+    {
+        int n = 0;
+        while (n < numSamples)
+        {
+            const int chunk = std::min (numSamples - n, B - inputPos);
+
+            std::copy (input + n, input + n + chunk, inputHistory.begin() + B + inputPos);
+            std::copy (outputBlock.begin() + inputPos, outputBlock.begin() + inputPos + chunk, output + n);
+
+            inputPos += chunk;
+            n += chunk;
+
+            if (inputPos == B)
+            {
+                processPartition();
+                inputPos = 0;
+            }
+        }
+    }
+
+    int getLatency() const       { return B; }
+    int getPartitionSize() const { return B; }
+    int getNumPartitions() const { return numActivePartitions; }
+
+    /**
+     * Rough cost in multiply-adds per output sample for an IR of
+     * numPartitions x partitionSize: two FFTs of 2B per B samples plus a
+     * complex MAC per bin per partition.
+     */
+    static float estimateCostPerSample (int partitionSize, int numPartitions)
+    {
+        const float fftLen = 2.0f * static_cast<float> (partitionSize);
+        const float fftCost = 2.0f * fftLen * std::log2 (fftLen);
+        const float macCost = 4.0f * static_cast<float> (numPartitions) * static_cast<float> (partitionSize + 1);
+        return (fftCost + macCost) / static_cast<float> (partitionSize);
+    }
+
+private:
+    void processPartition()
+    {
+        const size_t spectrumSize = static_cast<size_t> (2 * numBins);
+
+        // Overlap-save: transform [previous B | current B]
+        std::copy (inputHistory.begin(), inputHistory.end(), fftBuffer.begin());
+        std::fill (fftBuffer.begin() + fftSize, fftBuffer.end(), 0.0f);
+        fft->performRealOnlyForwardTransform (fftBuffer.data(), true);
+
+        float* slot = delayLine.data() + spectrumSize * static_cast<size_t> (delayLinePos);
+        std::copy (fftBuffer.begin(), fftBuffer.begin() + static_cast<std::ptrdiff_t> (spectrumSize), slot);
+
+        std::fill (accumulator.begin(), accumulator.end(), 0.0f);
+        const float* spectra = partitionSpectra[static_cast<size_t> (activeSpectra)].data();
+        float* acc = accumulator.data();
+
+        int slotIndex = delayLinePos;
+        for (int p = 0; p < numActivePartitions; ++p)
+        {
+            const float* x = delayLine.data() + spectrumSize * static_cast<size_t> (slotIndex);
+            const float* h = spectra + spectrumSize * static_cast<size_t> (p);
+
+            for (int k = 0; k < numBins; ++k)
+            {
+                const float xr = x[2 * k], xi = x[2 * k + 1];
+                const float hr = h[2 * k], hi = h[2 * k + 1];
+                acc[2 * k]     += xr * hr - xi * hi;
+                acc[2 * k + 1] += xr * hi + xi * hr;
+            }
+
+            if (--slotIndex < 0)
+                slotIndex = maxPartitions - 1;
+        }
+
+        std::copy (accumulator.begin(), accumulator.end(), fftBuffer.begin());
+        std::fill (fftBuffer.begin() + static_cast<std::ptrdiff_t> (spectrumSize), fftBuffer.end(), 0.0f);
+        fft->performRealOnlyInverseTransform (fftBuffer.data());
+
+        // Last B samples are the valid (non-aliased) part
+        std::copy (fftBuffer.begin() + B, fftBuffer.begin() + fftSize, outputBlock.begin());
+        std::copy (inputHistory.begin() + B, inputHistory.end(), inputHistory.begin());
+
+        if (++delayLinePos == maxPartitions)
+            delayLinePos = 0;
+    }
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    int B = 256;
+    int fftSize = 512;
+    int numBins = 257;
+    int maxPartitions = 1;
+    int maxIRLength = 0;
+
+    // Double-buffered partition spectra (interleaved re/im, numBins per partition)
+    std::array<std::vector<float>, 2> partitionSpectra;
+    int activeSpectra = 0;
+    int numActivePartitions = 0;
+
+    // Staged IR update
+    std::vector<float> pendingIR;        // staging buffer, zero between updates
+    float pendingGain = 1.0f;
+    int pendingLength = 0;
+    int pendingPartitions = 0;
+    int updatePartition = 0;
+    bool updating = false;
+
+    // Streaming state
+    std::vector<float> delayLine;        // frequency-domain delay line, maxPartitions slots
+    std::vector<float> accumulator;
+    std::vector<float> fftBuffer;
+    std::vector<float> inputHistory;     // [previous B | current B]
+    std::vector<float> outputBlock;
+    int inputPos = 0;
+    int delayLinePos = 0;
+};
+
+}  // namespace DSP
@@ -0,0 +1,2 @@
+#include "DSP/PreDelay.h"
+// Implementation is in the header.
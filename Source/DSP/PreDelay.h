@@ -0,0 +1,163 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+namespace DSP
+{
+
+/**
+ * Block-based integer pre-delay.
+ *
+ * Each channel is a plain ring buffer; a block is written and read back
+ * as at most two contiguous memcpy spans, so a static pre-delay costs two
+ * copies per channel per block.  When the delay time changes, the old and
+ * new read positions are crossfaded linearly instead of sliding a
+ * fractional read head, so there is no pitch bend and no interpolation.
+ */
+class PreDelay
+{
+public:
+    static constexpr int MAX_CHANNELS = 8;
+
+    PreDelay() = default;
+
+    void prepare (int numChannelsToUse, int maxDelaySamplesToUse,
+                  int maxBlockSize, int fadeSamples)
+    {
+        numChannels = std::clamp (numChannelsToUse, 1, MAX_CHANNELS);
+        maxDelaySamples = std::max (0, maxDelaySamplesToUse);
+        blockCapacity = std::max (1, maxBlockSize);
+        fadeLength = std::max (1, fadeSamples);
+
+        ringSize = maxDelaySamples + blockCapacity;
+        for (int ch = 0; ch < numChannels; ++ch)
+            rings[static_cast<size_t> (ch)].assign (static_cast<size_t> (ringSize), 0.0f);
+        fadeScratch.assign (static_cast<size_t> (blockCapacity), 0.0f);
+
+        reset();
+    }
+
+    void reset()
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            std::fill (rings[static_cast<size_t> (ch)].begin(),
+                       rings[static_cast<size_t> (ch)].end(), 0.0f);
+        writePos = 0;
+        fading = false;
+        fadePos = 0;
+        snapDelay = true;
+    }
+
+    /**
+     * Delays numSamples of every channel by delaySamples (clamped to the
+     * prepared maximum).  outputs may alias inputs.
+     * numSamples must not exceed the maxBlockSize given to prepare().
+     */
+    void process (const float* const* inputs, float* const* outputs,
+                  int numSamples, int delaySamples)
+    {
+        delaySamples = std::clamp (delaySamples, 0, maxDelaySamples);
+
+        if (snapDelay)
+        {
+            currentDelay = delaySamples;
+            snapDelay = false;
+        }
+
+        if (! fading && delaySamples != currentDelay)
+        {
+            previousDelay = currentDelay;
+            currentDelay = delaySamples;
+            fading = true;
+            fadePos = 0;
+        }
+
+        const int blockStart = writePos;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            float* ring = rings[static_cast<size_t> (ch)].data();
+            copyIn (ring, blockStart, inputs[ch], numSamples);
+
+            if (! fading)
+            {
+                copyOut (ring, readStart (blockStart, currentDelay), outputs[ch], numSamples);
+                continue;
+            }
+
+            float* from = fadeScratch.data();
+            copyOut (ring, readStart (blockStart, previousDelay), from, numSamples);
+            copyOut (ring, readStart (blockStart, currentDelay), outputs[ch], numSamples);
+
+            const float step = 1.0f / static_cast<float> (fadeLength);
+            float* out = outputs[ch];
+            for (int n = 0; n < numSamples; ++n)
+            {
+                const float g = std::min (1.0f, static_cast<float> (fadePos + n + 1) * step);
+                out[n] = from[n] + g * (out[n] - from[n]);
+            }
+        }
+
+        writePos += numSamples;
+        if (writePos >= ringSize)
+            writePos -= ringSize;
+
+        if (fading)
+        {
+            fadePos += numSamples;
+            if (fadePos >= fadeLength)
+                fading = false;
+        }
+    }
+
+    int getMaxDelaySamples() const { return maxDelaySamples; }
+    int getCurrentDelay() const    { return currentDelay; }
+    bool isFading() const          { return fading; }
+
+private:
+    int readStart (int blockStart, int delay) const
+    {
+        int r = blockStart - delay;
+        if (r < 0)
+            r += ringSize;
+        return r;
+    }
+
+    void copyIn (float* ring, int start, const float* src, int numSamples) const
+    {
+        const int first = std::min (numSamples, ringSize - start);
+        std::memcpy (ring + start, src, sizeof (float) * static_cast<size_t> (first));
+        if (first < numSamples)
+            std::memcpy (ring, src + first, sizeof (float) * static_cast<size_t> (numSamples - first));
+    }
+
+    void copyOut (const float* ring, int start, float* dst, int numSamples) const
+    {
+        const int first = std::min (numSamples, ringSize - start);
+        std::memcpy (dst, ring + start, sizeof (float) * static_cast<size_t> (first));
+        if (first < numSamples)
+            std::memcpy (dst + first, ring, sizeof (float) * static_cast<size_t> (numSamples - first));
+    }
+
+    int numChannels = 2;
+    int maxDelaySamples = 0;
+    int blockCapacity = 512;
+    int ringSize = 1;
+    int writePos = 0;
+
+    int currentDelay = 0;
+    int previousDelay = 0;
+    bool snapDelay = true;
+    bool fading = false;
+    int fadeLength = 1;
+    int fadePos = 0;
+
+    std::array<std::vector<float>, MAX_CHANNELS> rings;
+    std::vector<float> fadeScratch;
+};
+
+}  // namespace DSP
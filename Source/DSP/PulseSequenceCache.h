@@ -0,0 +1,92 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <cstdint>
+
+namespace DSP
+{
+
+/**
+ * Process-wide cache of generated velvet-noise sequences.
+ *
+ * Sequences are keyed by their generation parameters and handed out as
+ * shared_ptr<const Sequence>; the cache itself only keeps weak
+ * references, so a table lives exactly as long as some instance uses
+ * it.  With many plugin instances at the same sample rate, prepare()
+ * becomes a map lookup instead of an LCG + std::exp per pulse.
+ *
+ * Thread-safe, but locks: call from prepare / message thread only,
+ * never from processBlock.
+ */
+template <typename Sequence>
+class PulseSequenceCache
+{
+public:
+    struct Key
+    {
+        double sampleRate;
+        uint32_t seed;
+        float density;
+        float durationMs;
+
+        bool operator< (const Key& other) const
+        {
+            return std::tie (sampleRate, seed, density, durationMs)
+                 < std::tie (other.sampleRate, other.seed, other.density, other.durationMs);
+        }
+    };
+
+    static PulseSequenceCache& getInstance()
+    {
+        static PulseSequenceCache instance;
+        return instance;
+    }
+
+    /** Returns the cached sequence for 'key', calling generate() on a miss. */
+    template <typename Generator>
+    std::shared_ptr<const Sequence> getOrCreate (const Key& key, Generator&& generate)
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+
+        auto it = entries.find (key);
+        if (it != entries.end())
+            if (auto existing = it->second.lock())
+                return existing;
+
+        purgeExpired();
+
+        std::shared_ptr<const Sequence> created = generate();
+        entries[key] = created;
+        return created;
+    }
+
+    /** Number of sequences currently alive (for tests / diagnostics). */
+    size_t getNumLiveEntries()
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        purgeExpired();
+        return entries.size();
+    }
+
+private:
+    PulseSequenceCache() = default;
+
+    void purgeExpired()
+    {
+        for (auto it = entries.begin(); it != entries.end();)
+        {
+            if (it->second.expired())
+                it = entries.erase (it);
+            else
+                ++it;
+        }
+    }
+
+    std::mutex mutex;
+    std::map<Key, std::weak_ptr<const Sequence>> entries;
+};
+
+}  // namespace DSP
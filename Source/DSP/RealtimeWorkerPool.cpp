@@ -0,0 +1,2 @@
+#include "DSP/RealtimeWorkerPool.h"
+// Implementation is in the header.
@@ -0,0 +1,257 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace DSP
+{
+
+/**
+ * Fork/join helper threads for the audio thread.
+ *
+ * Workers are realtime juce::Threads spawned in start() (not on the
+ * audio thread), at most one per core beside the caller's, and watch
+ * one atomic word.  The audio thread hands over a batch with launch(),
+ * does its own work, then calls wait(): it claims and runs every job no
+ * worker has picked up yet, and only waits for jobs a worker is already
+ * running.  A sleeping or descheduled worker therefore never stalls the
+ * block, it just leaves its share to the caller.
+ *
+ * An idle worker spins briefly (blocks arrive back to back) and then
+ * blocks on its own event.  launch() signals only workers that are
+ * blocked.  wait() likewise spins only briefly for a running job, then
+ * sleeps on an event the worker finishing the batch signals, rechecking
+ * every millisecond.  Those events are the only locks the audio thread
+ * can touch, and nothing on them allocates.
+ *
+ * Jobs are plain function pointers with a context, so handing one over
+ * allocates nothing.
+ */
+class RealtimeWorkerPool
+{
+public:
+    static constexpr int MAX_JOBS    = 16;
+    static constexpr int MAX_WORKERS = 8;
+
+    struct Job
+    {
+        void (*function) (void* context) = nullptr;
+        void* context = nullptr;
+
+        void run() const { function (context); }
+    };
+
+    RealtimeWorkerPool() = default;
+    ~RealtimeWorkerPool() { stop(); }
+
+    /** Workers that can run beside the calling thread on this machine. */
+    static int getMaxUsefulWorkers()
+    {
+        return std::clamp (juce::SystemStats::getNumCpus() - 1, 0, MAX_WORKERS);
+    }
+
+    /**
+     * Spawns up to numWorkersToUse workers, never more than
+     * getMaxUsefulWorkers(); a no-op if that many are already running.
+     * options should describe the audio callback the jobs run within.
+     */
+    void start (int numWorkersToUse,
+                const juce::Thread::RealtimeOptions& options = juce::Thread::RealtimeOptions {})
+    {
+        numWorkersToUse = std::clamp (numWorkersToUse, 0, getMaxUsefulWorkers());
+        if (numWorkersToUse == getNumWorkers())
+            return;
+
+        stop();
+        stopping.store (false);
+        for (int i = 0; i < numWorkersToUse; ++i)
+        {
+            workers.push_back (std::make_unique<Worker> (*this, i));
+            if (! workers.back()->startRealtimeThread (options))
+                workers.back()->startThread (juce::Thread::Priority::highest);
+        }
+    }
+
+    void stop()
+    {
+        stopping.store (true);
+        for (auto& event : wakeUp)
+            event.signal();
+        for (auto& worker : workers)
+            worker->stopThread (-1);
+        workers.clear();
+
+        for (auto& event : wakeUp)
+            event.reset();
+        batchDone.reset();
+    }
+
+    int getNumWorkers() const { return static_cast<int> (workers.size()); }
+
+    /** Audio thread: publishes a batch.  The jobs are copied. */
+    void launch (const Job* jobsToRun, int numJobsToRun)
+    {
+        jassert (! batchOpen);
+        numJobs = std::clamp (numJobsToRun, 0, MAX_JOBS);
+        for (int i = 0; i < numJobs; ++i)
+            jobs[static_cast<size_t> (i)] = jobsToRun[i];
+
+        finished.store (0, std::memory_order_relaxed);
+        ++epoch;
+        cursor.store (pack (epoch, numJobs, 0), std::memory_order_seq_cst);
+        batchOpen = true;
+
+        // Either a worker sees the new batch before it blocks, or we see
+        // it asleep here (both sides store, then load, sequentially consistent)
+        for (size_t i = 0; i < sleeping.size(); ++i)
+            if (sleeping[i].load (std::memory_order_seq_cst))
+                wakeUp[i].signal();
+    }
+
+    /** Audio thread: runs the unclaimed jobs, then waits for the running ones. */
+    void wait()
+    {
+        if (! batchOpen)
+            return;
+
+        int index = 0;
+        while (claim (epoch, index))
+        {
+            jobs[static_cast<size_t> (index)].run();
+            finished.fetch_add (1, std::memory_order_acq_rel);
+        }
+
+        // Workers are running the rest: spin briefly, then sleep until the
+        // last one signals (or a millisecond passes, should that be missed)
+        for (int round = 0; finished.load (std::memory_order_acquire) < numJobs; ++round)
+        {
+            if (round < kSpinRounds)
+            {
+                juce::Thread::yield();
+                continue;
+            }
+
+            callerWaiting.store (true, std::memory_order_seq_cst);
+            if (finished.load (std::memory_order_seq_cst) < numJobs)
+                batchDone.wait (1);
+            callerWaiting.store (false, std::memory_order_relaxed);
+        }
+
+        batchOpen = false;
+    }
+
+private:
+    // cursor = epoch (32 bits) | job count (16 bits) | next job (16 bits),
+    // so a claim can never mix one batch's count with another's index
+    static uint64_t pack (uint32_t batch, int count, int next)
+    {
+        return (static_cast<uint64_t> (batch) << 32)
+             | (static_cast<uint64_t> (count) << 16)
+             | static_cast<uint64_t> (next);
+    }
+
+    bool claim (uint32_t batch, int& index)
+    {
+        int count = 0;
+        return claim (batch, index, count);
+    }
+
+    bool claim (uint32_t batch, int& index, int& count)
+    {
+        uint64_t state = cursor.load (std::memory_order_acquire);
+        for (;;)
+        {
+            count = static_cast<int> ((state >> 16) & 0xffffu);
+            const int next = static_cast<int> (state & 0xffffu);
+            if (static_cast<uint32_t> (state >> 32) != batch || next >= count)
+                return false;
+
+            if (cursor.compare_exchange_weak (state, state + 1, std::memory_order_acq_rel))
+            {
+                index = next;
+                return true;
+            }
+        }
+    }
+
+    void workerLoop (int workerIndex)
+    {
+        const auto slot = static_cast<size_t> (workerIndex);
+        juce::FloatVectorOperations::disableDenormalisedNumberSupport();
+
+        uint32_t seen = static_cast<uint32_t> (cursor.load (std::memory_order_acquire) >> 32);
+        int idleRounds = 0;
+
+        while (! stopping.load (std::memory_order_relaxed))
+        {
+            const uint32_t batch = static_cast<uint32_t> (cursor.load (std::memory_order_acquire) >> 32);
+            if (batch == seen)
+            {
+                // Spin briefly (blocks arrive back to back), then block until launch()
+                if (++idleRounds < kSpinRounds)
+                {
+                    juce::Thread::yield();
+                    continue;
+                }
+
+                sleeping[slot].store (true, std::memory_order_seq_cst);
+                if (static_cast<uint32_t> (cursor.load (std::memory_order_seq_cst) >> 32) == seen
+                    && ! stopping.load())
+                    wakeUp[slot].wait (-1);
+                sleeping[slot].store (false, std::memory_order_relaxed);
+
+                idleRounds = 0;
+                continue;
+            }
+
+            seen = batch;
+            idleRounds = 0;
+
+            int index = 0, count = 0;
+            while (claim (batch, index, count))
+            {
+                jobs[static_cast<size_t> (index)].run();
+
+                // The caller may be asleep in wait(): same store-then-load
+                // pairing as launch() and the sleeping flags
+                if (finished.fetch_add (1, std::memory_order_seq_cst) + 1 == count
+                    && callerWaiting.load (std::memory_order_seq_cst))
+                    batchDone.signal();
+            }
+        }
+    }
+
+    struct Worker : juce::Thread
+    {
+        Worker (RealtimeWorkerPool& ownerPool, int index)
+            : juce::Thread ("Realtime worker " + juce::String (index)), pool (ownerPool), workerIndex (index) {}
+
+        void run() override { pool.workerLoop (workerIndex); }
+
+        RealtimeWorkerPool& pool;
+        const int workerIndex;
+    };
+
+    static constexpr int kSpinRounds = 2000;
+
+    std::array<Job, MAX_JOBS> jobs {};
+    int numJobs = 0;
+    uint32_t epoch = 0;        // audio thread only
+    bool batchOpen = false;    // audio thread only
+
+    std::atomic<uint64_t> cursor { 0 };
+    std::atomic<int> finished { 0 };
+    std::atomic<bool> stopping { false };
+    std::array<std::atomic<bool>, MAX_WORKERS> sleeping {};
+    std::array<juce::WaitableEvent, MAX_WORKERS> wakeUp;
+    std::atomic<bool> callerWaiting { false };
+    juce::WaitableEvent batchDone;
+    std::vector<std::unique_ptr<Worker>> workers;
+};
+
+}  // namespace DSP
@@ -2,29 +2,70 @@
 
 #include <cmath>
 #include <algorithm>
-#include <cstdint>
+#include <array>
 
 namespace DSP
 {
 
 /**
  * Dry / Early Reflections / Late (FDN) / DVN Tail mixing.
- * v3: Called per-sample with smoothed parameters from the processor.
- *     Added denormal kill on output.
+ * v3: Added denormal kill on output.
+ * v4: processBlock() mixes whole blocks with linear gain ramps; the dB
+ *     conversions run once per block instead of once per sample.
+ * v5: Branch-free output clip with an optional first-order ADAA
+ *     variant.  No per-sample denormal kill: the processor runs under
+ *     ScopedNoDenormals (FTZ/DAZ).
  */
 class ReverbMixer
 {
 public:
+    /** Mix gains in the linear domain. */
+    struct Gains
+    {
+        float dry   = 0.7f;
+        float wet   = 0.3f;
+        float early = 0.707f;
+        float late  = 0.5f;
+        float width = 0.7f;
+    };
+
     ReverbMixer() = default;
 
+    static Gains makeGains (float dryWetPercent, float earlyLevelDb,
+                            float lateLevelDb, float stereoWidthPercent)
+    {
+        Gains g;
+        g.wet   = dryWetPercent * 0.01f;
+        g.dry   = 1.0f - g.wet;
+        g.early = std::pow (10.0f, earlyLevelDb / 20.0f);
+        g.late  = std::pow (10.0f, lateLevelDb / 20.0f);
+        g.width = stereoWidthPercent * 0.01f;
+        return g;
+    }
+
+    /**
+     * Antiderivative anti-aliasing on the output clip: the clip aliases
+     * less when driven, at the cost of half a sample of delay.
+     */
+    void setClipAntiAliasing (bool shouldUseAdaa)
+    {
+        if (shouldUseAdaa != clipAdaa)
+        {
+            clipAdaa = shouldUseAdaa;
+            reset();
+        }
+    }
+
+    void reset()
+    {
+        lastClipInput = { 0.0f, 0.0f };
+    }
+
+    /** Sets the gains immediately (no ramp). */
     void setParameters (float dryWetPercent, float earlyLevelDb,
                         float lateLevelDb, float stereoWidthPercent)
     {
-        wet = dryWetPercent * 0.01f;
-        dry = 1.0f - wet;
-        earlyGain = std::pow (10.0f, earlyLevelDb / 20.0f);
-        lateGain = std::pow (10.0f, lateLevelDb / 20.0f);
-        stereoWidth = stereoWidthPercent * 0.01f;
+        gains = makeGains (dryWetPercent, earlyLevelDb, lateLevelDb, stereoWidthPercent);
     }
 
     void process (float dryL, float dryR,
@@ -33,45 +74,139 @@ public:
                   float dvnL, float dvnR,
                   float& outL, float& outR) const
     {
-        float wetL = earlyGain * earlyL + lateGain * (lateL + dvnL);
-        float wetR = earlyGain * earlyR + lateGain * (lateR + dvnR);
+        float wetL = gains.early * earlyL + gains.late * (lateL + dvnL);
+        float wetR = gains.early * earlyR + gains.late * (lateR + dvnR);
 
         float mid  = (wetL + wetR) * 0.5f;
         float side = (wetL - wetR) * 0.5f;
-        wetL = mid + side * stereoWidth;
-        wetR = mid - side * stereoWidth;
+        wetL = mid + side * gains.width;
+        wetR = mid - side * gains.width;
+
+        outL = softClip (gains.dry * dryL + gains.wet * wetL);
+        outR = softClip (gains.dry * dryR + gains.wet * wetR);
+    }
+
+    /**
+     * Block version of process() on stereo pointer pairs ([0] = L, [1] = R),
+     * in place: io holds the dry signal and receives the mix.  The gains
+     * ramp linearly from the current ones to target, reaching it on the
+     * last sample, which then becomes current.  Every sample is
+     * independent of the previous one, so the mix and clip loops
+     * vectorise.
+     */
+    void processBlock (float* const* io, const float* const* early,
+                       const float* const* late, const float* const* dvn,
+                       int numSamples, const Gains& target)
+    {
+        if (numSamples <= 0)
+            return;
+
+        const float inv = 1.0f / static_cast<float> (numSamples);
+        const Gains from = gains;
+        const Gains step { (target.dry - from.dry) * inv, (target.wet - from.wet) * inv,
+                           (target.early - from.early) * inv, (target.late - from.late) * inv,
+                           (target.width - from.width) * inv };
 
-        outL = softClip (dry * dryL + wet * wetL);
-        outR = softClip (dry * dryR + wet * wetR);
+        float* outL = io[0];
+        float* outR = io[1];
+        const float* earlyL = early[0]; const float* earlyR = early[1];
+        const float* lateL = late[0]; const float* lateR = late[1];
+        const float* dvnL = dvn[0];   const float* dvnR = dvn[1];
 
-        // Denormal kill
-        outL = killDenormal (outL);
-        outR = killDenormal (outR);
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float t = static_cast<float> (i + 1);
+            const float gDry   = from.dry   + step.dry   * t;
+            const float gWet   = from.wet   + step.wet   * t;
+            const float gEarly = from.early + step.early * t;
+            const float gLate  = from.late  + step.late  * t;
+            const float gWidth = from.width + step.width * t;
+
+            float wetL = gEarly * earlyL[i] + gLate * (lateL[i] + dvnL[i]);
+            float wetR = gEarly * earlyR[i] + gLate * (lateR[i] + dvnR[i]);
+
+            const float mid  = (wetL + wetR) * 0.5f;
+            const float side = (wetL - wetR) * 0.5f;
+            wetL = mid + side * gWidth;
+            wetR = mid - side * gWidth;
+
+            outL[i] = gDry * outL[i] + gWet * wetL;
+            outR[i] = gDry * outR[i] + gWet * wetR;
+        }
+
+        gains = target;
+
+        for (size_t ch = 0; ch < 2; ++ch)
+        {
+            if (clipAdaa)
+                softClipBlockAdaa (io[ch], numSamples, lastClipInput[ch]);
+            else
+                softClipBlock (io[ch], numSamples);
+        }
     }
 
 private:
+    static constexpr float kClipKnee = 1.5f;
+    static constexpr double kAdaaEpsilon = 1.0e-4;
+    static constexpr int kClipChunk = 64;
+
+    /** Cubic soft clip, x - x^3 / 6.75 up to |x| = 1.5 (where it reaches 1). */
     static float softClip (float x)
     {
-        if (x > 1.5f)  return 1.0f;
-        if (x < -1.5f) return -1.0f;
-        return x - (x * x * x) / 6.75f;
+        x = std::clamp (x, -kClipKnee, kClipKnee);
+        return x - x * x * x * (1.0f / 6.75f);
+    }
+
+    /** Antiderivative of softClip: x^2/2 - x^4/27 inside, |x| - 0.5625 outside. */
+    static double softClipAntiderivative (double x)
+    {
+        const double c = std::clamp (x, -static_cast<double> (kClipKnee), static_cast<double> (kClipKnee));
+        const double c2 = c * c;
+        return 0.5 * c2 - c2 * c2 * (1.0 / 27.0) + (std::abs (x) - std::abs (c));
+    }
+
+    static void softClipBlock (float* data, int numSamples)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            data[i] = softClip (data[i]);
     }
 
-    static float killDenormal (float x)
+    /**
+     * First-order ADAA: (F(x[n]) - F(x[n-1])) / (x[n] - x[n-1]), with the
+     * midpoint clip where the two are too close to divide.  Both are
+     * computed and one selected, so the loop stays branch-free.
+     */
+    static void softClipBlockAdaa (float* data, int numSamples, float& lastInput)
     {
-        // Bit-level check: exponent field all zeros = denormal or zero
-        union { float f; uint32_t i; } u;
-        u.f = x;
-        if ((u.i & 0x7F800000u) == 0)
-            return 0.0f;
-        return x;
+        std::array<float, kClipChunk + 1> x;
+
+        for (int start = 0; start < numSamples; start += kClipChunk)
+        {
+            const int n = std::min (kClipChunk, numSamples - start);
+            float* block = data + start;
+
+            x[0] = lastInput;
+            std::copy (block, block + n, x.begin() + 1);
+
+            for (int i = 0; i < n; ++i)
+            {
+                const double x0 = x[static_cast<size_t> (i + 1)];
+                const double x1 = x[static_cast<size_t> (i)];
+                const double d = x0 - x1;
+                const bool close = std::abs (d) < kAdaaEpsilon;
+                const double quotient = (softClipAntiderivative (x0) - softClipAntiderivative (x1))
+                                      / (close ? 1.0 : d);
+                const float midpoint = softClip (static_cast<float> (0.5 * (x0 + x1)));
+                block[i] = close ? midpoint : static_cast<float> (quotient);
+            }
+
+            lastInput = x[static_cast<size_t> (n)];
+        }
     }
 
-    float dry = 0.7f;
-    float wet = 0.3f;
-    float earlyGain = 0.707f;
-    float lateGain = 0.5f;
-    float stereoWidth = 0.7f;
+    Gains gains;
+    bool clipAdaa = false;
+    std::array<float, 2> lastClipInput {};
 };
 
 }  // namespace DSP
@@ -1,7 +1,10 @@
 ﻿#pragma once
 
+#include "DSP/FastMath.h"
+#include <array>
 #include <cmath>
 #include <algorithm>
+#include <type_traits>
 
 namespace DSP
 {
@@ -9,6 +12,13 @@ namespace DSP
 /**
  * 4 タイプの FDN 内サチュレーション。
  * FeedbackMatrix 直後、AttenuationFilter 直前に配置。
+ *
+ * Optional antiderivative anti-aliasing (ADAA): instead of f(x[n]) the
+ * output is the mean of f over the segment between consecutive driven
+ * samples, (F1(x[n]) - F1(x[n-1])) / (x[n] - x[n-1]) for first order,
+ * or the second divided difference of F2 for second order.  This
+ * suppresses aliasing at the base rate at the cost of half a sample
+ * (first order) or one sample (second order) of delay.
  */
 class Saturation
 {
@@ -21,6 +31,13 @@ public:
         Tube = 3    // 正負で異なる tanh ゲイン → 偶数次
     };
 
+    enum class AntiAlias
+    {
+        Off    = 0,
+        First  = 1,   // ADAA, 1 次 (F1 = ∫f)
+        Second = 2    // ADAA, 2 次 (F2 = ∫∫f)
+    };
+
     Saturation() = default;
 
     void setParameters (float amountPercent, float driveDbs,
@@ -28,10 +45,28 @@ public:
     {
         amount = amountPercent * 0.01f;
         driveLinear = std::pow (10.0f, driveDbs / 20.0f);
-        type = static_cast<Type> (std::clamp (typeIndex, 0, 3));
         asymmetryOffset = asymmetryPercent * 0.002f;  // 0-100% → 0-0.2
+
+        const auto newType = static_cast<Type> (std::clamp (typeIndex, 0, 3));
+        if (newType != type)
+            adaaPrimed = false;   // cached antiderivatives belong to the old curve
+        type = newType;
     }
 
+    void setAntiAliasing (int modeIndex)
+    {
+        const auto newMode = static_cast<AntiAlias> (std::clamp (modeIndex, 0, 2));
+        if (newMode != antiAlias)
+            adaaPrimed = false;
+        antiAlias = newMode;
+    }
+
+    /** False when amount is zero and process() is a pass-through. */
+    bool isActive() const          { return amount >= 1.0e-6f; }
+
+    Type getType() const           { return type; }
+    AntiAlias getAntiAliasing() const { return antiAlias; }
+
     void prepare (double sampleRate)
     {
         // DC ブロッカー (10Hz ハイパス)
@@ -40,104 +75,383 @@ public:
         dcBlockCoeff = std::max (0.9f, std::min (0.9999f, dcBlockCoeff));
         dcX1 = 0.0f;
         dcY1 = 0.0f;
+        adaaPrimed = false;
     }
 
     float process (float input)
     {
-        if (amount < 1.0e-6f)
-            return input;  // 完全バイパス
+        float output = input;
+        dispatch (type, antiAlias, [&] (auto t, auto a)
+        {
+            output = processSample<decltype (t)::value, decltype (a)::value> (input);
+        });
+        return output;
+    }
 
-        // Drive 適用
-        float driven = input * driveLinear;
+    /**
+     * Block version of process(): the type switch runs once per call and
+     * the shaping loop is branch-free.  input and output may alias.
+     */
+    void processBlock (const float* input, float* output, int numSamples)
+    {
+        dispatch (type, antiAlias, [&] (auto t, auto a)
+        {
+            processBlockImpl<decltype (t)::value, decltype (a)::value> (input, output, numSamples);
+        });
+    }
 
-        // 非対称オフセット
-        driven += asymmetryOffset;
+    /**
+     * One sample on each of a bank of saturators (the FDN channels).
+     * All of them must share the same type and anti-aliasing mode, as
+     * FDNReverb sets them together; the switch is taken once per frame.
+     */
+    template <size_t N>
+    static void processFrame (std::array<Saturation, N>& saturators,
+                              const std::array<float, N>& input,
+                              std::array<float, N>& output)
+    {
+        dispatch (saturators[0].type, saturators[0].antiAlias, [&] (auto t, auto a)
+        {
+            for (size_t i = 0; i < N; ++i)
+                output[i] = saturators[i].template processSample<decltype (t)::value,
+                                                                 decltype (a)::value> (input[i]);
+        });
+    }
 
-        // 非線形関数適用
+    void reset()
+    {
+        // Pre-initialize DC blocker state so zero input produces zero output
+        // even when asymmetry offset is non-zero
+        float driven = asymmetryOffset;
         float saturated = applyNonlinearity (driven);
+        dcX1 = saturated;
+        dcY1 = 0.0f;
+        adaaPrimed = false;
+    }
 
-        // DC ブロッカー（非対称オフセットが有効な場合のみ）
-        float result;
-        if (std::abs (asymmetryOffset) > 1.0e-6f)
+    /**
+     * Static transfer curve for one type, without drive, offset or blend.
+     * tanh is FastMath::tanh (|error| < 1e-4); the sign-dependent gains
+     * of Tape/Tube are selects rather than branches.
+     */
+    template <Type T>
+    static float shape (float x)
+    {
+        if constexpr (T == Type::Soft)
         {
-            float dcBlocked = saturated - dcX1 + dcBlockCoeff * dcY1;
-            dcX1 = saturated;
-            dcY1 = dcBlocked;
+            // 3 次多項式ソフトクリップ: y = 1.5x - 0.5x^3 (|x| <= 1)
+            const float c = std::clamp (x, -1.0f, 1.0f);
+            return 1.5f * c - 0.5f * c * c * c;
+        }
+        else
+        {
+            // Tape: 正側 tanh / 負側 tanh(0.8x)*1.25
+            // Tube: 正側 tanh(1.2x) / 負側 tanh(0.8x)
+            constexpr auto g = tanhGains<T>();
+            const bool positive = x >= 0.0f;
+            const float inGain  = positive ? g.posIn  : g.negIn;
+            const float outGain = positive ? g.posOut : g.negOut;
+            return outGain * FastMath::tanh (inGain * x);
+        }
+    }
 
-            // NaN/Inf 伝播防止: DC ブロッカー状態をリセット
-            if (std::isnan (dcY1) || std::isinf (dcY1))
-            {
-                dcX1 = 0.0f;
-                dcY1 = 0.0f;
-                dcBlocked = 0.0f;
-            }
+    /** First antiderivative of shape<T> (F1' = f, F1(0) = 0), in double. */
+    template <Type T>
+    static double antiderivative1 (double x)
+    {
+        if constexpr (T == Type::Soft)
+        {
+            const double a = std::abs (x);
+            if (a <= 1.0)
+                return x * x * (0.75 - 0.125 * x * x);
+            return a - 0.375;
+        }
+        else
+        {
+            // ∫ g_out tanh(g_in x) = g_out / g_in * log cosh(g_in x)
+            constexpr auto g = tanhGains<T>();
+            const bool positive = x >= 0.0;
+            const double inGain  = positive ? g.posIn  : g.negIn;
+            const double outGain = positive ? g.posOut : g.negOut;
+            return outGain / inGain * logCosh (inGain * x);
+        }
+    }
 
-            result = dcBlocked;
+    /** Second antiderivative of shape<T> (F2' = F1, F2(0) = 0), in double. */
+    template <Type T>
+    static double antiderivative2 (double x)
+    {
+        if constexpr (T == Type::Soft)
+        {
+            const double a = std::abs (x);
+            if (a <= 1.0)
+                return x * x * x * (0.25 - 0.025 * x * x);
+            return std::copysign (0.5 * a * a - 0.375 * a + 0.1, x);
         }
         else
         {
-            result = saturated;
+            constexpr auto g = tanhGains<T>();
+            const bool positive = x >= 0.0;
+            const double inGain  = positive ? g.posIn  : g.negIn;
+            const double outGain = positive ? g.posOut : g.negOut;
+            return outGain / (inGain * inGain) * logCoshIntegral (inGain * x);
         }
+    }
 
-        // Amount ブレンド
-        return (1.0f - amount) * input + amount * result;
+private:
+    static constexpr int kBlockChunk = 64;
+
+    /** Below this spacing of driven samples the divided differences fall back to f(midpoint). */
+    static constexpr double kAdaaEpsilon = 1.0e-4;
+
+    /** Input/output gains of the tanh-based types per polarity. */
+    struct TanhGains { float posIn, posOut, negIn, negOut; };
+
+    template <Type T>
+    static constexpr TanhGains tanhGains()
+    {
+        if constexpr (T == Type::Tape)      return { 1.0f, 1.0f, 0.8f, 1.25f };
+        else if constexpr (T == Type::Tube) return { 1.2f, 1.0f, 0.8f, 1.0f };
+        else                                return { 1.0f, 1.0f, 1.0f, 1.0f };
     }
 
-    void reset()
+    /** Calls fn (typeTag, antiAliasTag) with both modes as compile-time constants. */
+    template <typename Fn>
+    static void dispatch (Type t, AntiAlias a, Fn&& fn)
     {
-        // Pre-initialize DC blocker state so zero input produces zero output
-        // even when asymmetry offset is non-zero
-        float driven = asymmetryOffset;
-        float saturated = applyNonlinearity (driven);
-        dcX1 = saturated;
-        dcY1 = 0.0f;
+        switch (t)
+        {
+            case Type::Soft: dispatchAntiAlias<Type::Soft> (a, fn); break;
+            case Type::Tape: dispatchAntiAlias<Type::Tape> (a, fn); break;
+            case Type::Tube: dispatchAntiAlias<Type::Tube> (a, fn); break;
+            case Type::Warm:
+            default:         dispatchAntiAlias<Type::Warm> (a, fn); break;
+        }
+    }
+
+    template <Type T, typename Fn>
+    static void dispatchAntiAlias (AntiAlias a, Fn& fn)
+    {
+        using TypeTag = std::integral_constant<Type, T>;
+        switch (a)
+        {
+            case AntiAlias::First:  fn (TypeTag {}, std::integral_constant<AntiAlias, AntiAlias::First> {}); break;
+            case AntiAlias::Second: fn (TypeTag {}, std::integral_constant<AntiAlias, AntiAlias::Second> {}); break;
+            case AntiAlias::Off:
+            default:                fn (TypeTag {}, std::integral_constant<AntiAlias, AntiAlias::Off> {}); break;
+        }
     }
 
-private:
     float applyNonlinearity (float x) const
     {
-        switch (type)
+        float y = x;
+        dispatch (type, AntiAlias::Off, [&] (auto t, auto)
         {
-            case Type::Soft:
-            {
-                // 3 次多項式ソフトクリップ: y = 1.5x - 0.5x^3 (|x| <= 1)
-                float clamped = std::clamp (x, -1.0f, 1.0f);
-                return 1.5f * clamped - 0.5f * clamped * clamped * clamped;
-            }
-            case Type::Warm:
+            y = shape<decltype (t)::value> (x);
+        });
+        return y;
+    }
+
+    /** log(cosh(x)) without overflow. */
+    static double logCosh (double x)
+    {
+        const double a = std::abs (x);
+        return a + std::log1p (std::exp (-2.0 * a)) - 0.69314718055994530942;
+    }
+
+    /**
+     * ∫0^x log cosh(t) dt, odd in x.  For a = |x|:
+     *   a^2/2 - a ln2 + (Li2(-e^{-2a}) + pi^2/12) / 2
+     */
+    static double logCoshIntegral (double x)
+    {
+        const double a = std::abs (x);
+        const double e = std::exp (-2.0 * a);
+        const double g = 0.5 * a * a - 0.69314718055994530942 * a
+                       + 0.5 * (dilogNegative (e) + 0.82246703342411321824);   // pi^2/12
+        return std::copysign (g, x);
+    }
+
+    /**
+     * Li2(-t) for t in [0, 1].  Mapped to w = t / (1 + t) <= 1/2 by
+     * Li2(z) = -Li2(z / (z - 1)) - ln^2(1 - z) / 2, then the Bernoulli
+     * series in u = -ln(1 - w) <= ln 2 (truncation error < 1e-12).
+     */
+    static double dilogNegative (double t)
+    {
+        const double l = std::log1p (t);          // ln(1 - z), z = -t
+        const double u = l;                       // -ln(1 - w) = ln(1 + t)
+        const double u2 = u * u;
+        const double li2w = u * (1.0 + u * (-0.25 + u * (1.0 / 36.0
+                          + u2 * (-1.0 / 3600.0 + u2 * (1.0 / 211680.0
+                          + u2 * (-1.0 / 10886400.0 + u2 * (1.0 / 526901760.0
+                          + u2 * (-4.0647616451442255e-11))))))));
+        return -li2w - 0.5 * l * l;
+    }
+
+    bool hasAsymmetry() const { return std::abs (asymmetryOffset) > 1.0e-6f; }
+
+    float dcBlock (float saturated)
+    {
+        float dcBlocked = saturated - dcX1 + dcBlockCoeff * dcY1;
+        dcX1 = saturated;
+        dcY1 = dcBlocked;
+
+        // NaN/Inf 伝播防止: DC ブロッカー状態をリセット
+        if (std::isnan (dcY1) || std::isinf (dcY1))
+        {
+            dcX1 = 0.0f;
+            dcY1 = 0.0f;
+            dcBlocked = 0.0f;
+        }
+
+        return dcBlocked;
+    }
+
+    /** Divided difference (F2(a) - F2(b)) / (a - b), given F2 at both ends. */
+    template <Type T>
+    static double firstDifference2 (double a, double b, double f2a, double f2b)
+    {
+        const double d = a - b;
+        if (std::abs (d) < kAdaaEpsilon)
+            return antiderivative1<T> (0.5 * (a + b));
+        return (f2a - f2b) / d;
+    }
+
+    template <Type T, AntiAlias A>
+    float shapeAntiAliased (float drivenSample)
+    {
+        if constexpr (A == AntiAlias::Off)
+        {
+            return shape<T> (drivenSample);
+        }
+        else
+        {
+            const double x0 = drivenSample;
+
+            if (! adaaPrimed)
             {
-                return std::tanh (x);
+                // Start from a flat history: the first output is f(x0)
+                adaaX1 = adaaX2 = x0;
+                adaaF1 = antiderivative1<T> (x0);
+                adaaF2 = antiderivative2<T> (x0);
+                adaaD1 = adaaF1;
+                adaaPrimed = true;
             }
-            case Type::Tape:
+
+            if constexpr (A == AntiAlias::First)
             {
-                // 正側 tanh / 負側 tanh(0.8x)*1.25
-                if (x >= 0.0f)
-                    return std::tanh (x);
-                else
-                    return std::tanh (0.8f * x) * 1.25f;
+                const double f1 = antiderivative1<T> (x0);
+                const double d = x0 - adaaX1;
+                const double y = std::abs (d) < kAdaaEpsilon
+                               ? static_cast<double> (shape<T> (static_cast<float> (0.5 * (x0 + adaaX1))))
+                               : (f1 - adaaF1) / d;
+                adaaX1 = x0;
+                adaaF1 = f1;
+                return static_cast<float> (y);
             }
-            case Type::Tube:
+            else
             {
-                // 正側 tanh(1.2x) / 負側 tanh(0.8x)
-                if (x >= 0.0f)
-                    return std::tanh (1.2f * x);
+                const double x1 = adaaX1, x2 = adaaX2;
+                const double f2 = antiderivative2<T> (x0);
+                const double d0 = firstDifference2<T> (x0, x1, f2, adaaF2);
+
+                double y;
+                const double span = x0 - x2;
+                if (std::abs (span) >= kAdaaEpsilon)
+                {
+                    y = 2.0 * (d0 - adaaD1) / span;
+                }
                 else
-                    return std::tanh (0.8f * x);
+                {
+                    // x0 ~ x2: expand around their mean
+                    const double mean = 0.5 * (x0 + x2);
+                    const double delta = mean - x1;
+                    if (std::abs (delta) < kAdaaEpsilon)
+                        y = shape<T> (static_cast<float> (0.5 * (mean + x1)));
+                    else
+                        y = 2.0 / delta * (antiderivative1<T> (mean)
+                                           + (adaaF2 - antiderivative2<T> (mean)) / delta);
+                }
+
+                adaaX2 = x1;
+                adaaX1 = x0;
+                adaaF2 = f2;
+                adaaD1 = d0;
+                return static_cast<float> (y);
             }
-            default:
-                return std::tanh (x);
+        }
+    }
+
+    template <Type T, AntiAlias A>
+    float processSample (float input)
+    {
+        if (amount < 1.0e-6f)
+        {
+            adaaPrimed = false;
+            return input;  // 完全バイパス
+        }
+
+        // Drive + 非対称オフセット → 非線形関数
+        float result = shapeAntiAliased<T, A> (input * driveLinear + asymmetryOffset);
+
+        // DC ブロッカー（非対称オフセットが有効な場合のみ）
+        if (hasAsymmetry())
+            result = dcBlock (result);
+
+        // Amount ブレンド
+        return (1.0f - amount) * input + amount * result;
+    }
+
+    template <Type T, AntiAlias A>
+    void processBlockImpl (const float* input, float* output, int numSamples)
+    {
+        if (amount < 1.0e-6f)
+        {
+            adaaPrimed = false;
+            if (output != input)
+                std::copy (input, input + numSamples, output);
+            return;
+        }
+
+        const bool dcActive = hasAsymmetry();
+        const float dry = 1.0f - amount;
+        std::array<float, kBlockChunk> shaped;
+
+        for (int start = 0; start < numSamples; start += kBlockChunk)
+        {
+            const int count = std::min (kBlockChunk, numSamples - start);
+            const float* in = input + start;
+
+            for (int i = 0; i < count; ++i)
+                shaped[static_cast<size_t> (i)] = shapeAntiAliased<T, A> (in[i] * driveLinear + asymmetryOffset);
+
+            if (dcActive)
+                for (int i = 0; i < count; ++i)
+                    shaped[static_cast<size_t> (i)] = dcBlock (shaped[static_cast<size_t> (i)]);
+
+            for (int i = 0; i < count; ++i)
+                output[start + i] = dry * in[i] + amount * shaped[static_cast<size_t> (i)];
         }
     }
 
     float amount = 0.0f;
     float driveLinear = 1.0f;
     Type type = Type::Warm;
+    AntiAlias antiAlias = AntiAlias::Off;
     float asymmetryOffset = 0.0f;
 
     // DC ブロッカー
     float dcBlockCoeff = 0.995f;
     float dcX1 = 0.0f;
     float dcY1 = 0.0f;
+
+    // ADAA history (driven samples and cached antiderivatives)
+    bool adaaPrimed = false;
+    double adaaX1 = 0.0, adaaX2 = 0.0;
+    double adaaF1 = 0.0;   // F1(x1), first order
+    double adaaF2 = 0.0;   // F2(x1), second order
+    double adaaD1 = 0.0;   // (F2(x1) - F2(x2)) / (x1 - x2)
 };
 
 }  // namespace DSP
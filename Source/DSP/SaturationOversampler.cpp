@@ -0,0 +1,2 @@
+#include "DSP/SaturationOversampler.h"
+// Implementation is in the header.
@@ -0,0 +1,233 @@
+#pragma once
+
+#include "DSP/Saturation.h"
+#include "DSP/HalfbandResampler.h"
+#include <array>
+#include <algorithm>
+
+namespace DSP
+{
+
+/**
+ * Local polyphase oversampling around a bank of saturators.
+ *
+ * Each frame, every channel is interpolated by 2 per stage (up to 4
+ * halfband stages: 2x ... 16x), saturated at the high rate and
+ * decimated back, so only the nonlinearity pays for the higher rate.
+ * The first stage uses the full-length halfband so the base band stays
+ * flat inside a feedback loop; the inner stages only have to keep the
+ * bottom quarter of their band and use the short design.  Inside a
+ * feedback loop the filters add getLatency() loop samples, which the
+ * caller takes off its delay lines.  The channels run in lockstep, so
+ * the filter loops vectorise across them.
+ *
+ * The saturators must be prepared at the base rate times getFactor().
+ * All state is fixed-size; nothing here allocates.
+ */
+template <size_t N>
+class SaturationOversampler
+{
+public:
+    static constexpr int MAX_STAGES = 4;
+    static constexpr int MAX_FACTOR = 1 << MAX_STAGES;
+
+    /** numStagesToUse: 0 = off, 1 = 2x, 2 = 4x, 3 = 8x, 4 = 16x. */
+    void prepare (int numStagesToUse)
+    {
+        numStages = std::clamp (numStagesToUse, 0, MAX_STAGES);
+        reset();
+    }
+
+    void reset()
+    {
+        firstInterpolator.reset();
+        firstDecimator.reset();
+        for (auto& stage : innerInterpolators) stage.reset();
+        for (auto& stage : innerDecimators)    stage.reset();
+    }
+
+    int getNumStages() const { return numStages; }
+    int getFactor() const    { return 1 << numStages; }
+
+    /**
+     * Round-trip delay in base-rate samples: each stage's interpolator
+     * and decimator delay by LATENCY samples of that stage's rate.
+     */
+    float getLatency() const
+    {
+        float latency = 0.0f;
+        for (int s = 1; s <= numStages; ++s)
+        {
+            const int stageLatency = s == 1 ? HalfbandCoefficients::LATENCY
+                                            : ShortHalfbandCoefficients::LATENCY;
+            latency += 2.0f * static_cast<float> (stageLatency) / static_cast<float> (1 << s);
+        }
+        return latency;
+    }
+
+    /** One base-rate sample per channel, as Saturation::processFrame. */
+    void processFrame (std::array<Saturation, N>& saturators,
+                       const std::array<float, N>& input,
+                       std::array<float, N>& output)
+    {
+        processFrame (saturators, input, output, [] (float x) { return x; });
+    }
+
+    /**
+     * As above, with postShaper (float -> float) applied to every
+     * high-rate sample after the saturator, so a following nonlinearity
+     * such as a safety clamp is anti-aliased too.
+     */
+    template <typename PostShaper>
+    void processFrame (std::array<Saturation, N>& saturators,
+                       const std::array<float, N>& input,
+                       std::array<float, N>& output,
+                       PostShaper&& postShaper)
+    {
+        const int factor = getFactor();
+
+        // Up: stage s turns 2^s frames into 2^(s+1), in time order
+        std::array<Frame, MAX_FACTOR> bufferA, bufferB;
+        Frame* high = bufferA.data();
+        Frame* next = bufferB.data();
+        high[0] = input;
+        for (int s = 0, count = 1; s < numStages; ++s, count *= 2)
+        {
+            for (int k = 0; k < count; ++k)
+            {
+                if (s == 0)
+                    firstInterpolator.process (high[k], next[2 * k], next[2 * k + 1]);
+                else
+                    innerInterpolators[static_cast<size_t> (s - 1)].process (high[k], next[2 * k], next[2 * k + 1]);
+            }
+            std::swap (high, next);
+        }
+
+        for (int k = 0; k < factor; ++k)
+        {
+            Saturation::processFrame (saturators, high[k], high[k]);
+            for (auto& x : high[k])
+                x = postShaper (x);
+        }
+
+        // Down in reverse stage order, in place: frame k is written after
+        // frames 2k and 2k + 1 have been read
+        for (int s = numStages - 1, count = factor / 2; s >= 0; --s, count /= 2)
+        {
+            for (int k = 0; k < count; ++k)
+            {
+                if (s == 0)
+                    firstDecimator.process (high[2 * k], high[2 * k + 1], high[k]);
+                else
+                    innerDecimators[static_cast<size_t> (s - 1)].process (high[2 * k], high[2 * k + 1], high[k]);
+            }
+        }
+
+        output = high[0];
+    }
+
+private:
+    using Frame = std::array<float, N>;
+
+    /**
+     * The N channels of a halfband stage in lockstep, one frame per
+     * sample: the inner loops run across channels and vectorise, and all
+     * channels share a single phase.  Same filters as
+     * BasicHalfbandInterpolator / BasicHalfbandDecimator.
+     */
+    template <typename Coefficients>
+    struct FrameInterpolator
+    {
+        static constexpr int HISTORY = Coefficients::NUM_EVEN;
+
+        void reset()
+        {
+            for (auto& frame : history)
+                frame.fill (0.0f);
+            writePos = 0;
+        }
+
+        /** One frame in, the even and odd output frames out. */
+        void process (const Frame& in, Frame& even, Frame& odd)
+        {
+            history[static_cast<size_t> (writePos)] = in;
+            history[static_cast<size_t> (writePos + HISTORY)] = in;
+            if (++writePos == HISTORY)
+                writePos = 0;
+
+            const auto& h = Coefficients::get().even;
+            const Frame* y = history.data() + writePos;   // y[HISTORY - 1] newest
+
+            Frame acc {};
+            for (int j = 0; j < HISTORY; ++j)
+            {
+                const float hj = 2.0f * h[static_cast<size_t> (j)];
+                const Frame& yj = y[HISTORY - 1 - j];
+                for (size_t c = 0; c < N; ++c)
+                    acc[c] += hj * yj[c];
+            }
+
+            odd = y[HISTORY - 1 - (Coefficients::CENTRE - 1) / 2];
+            even = acc;
+        }
+
+        std::array<Frame, 2 * HISTORY> history {};
+        int writePos = 0;
+    };
+
+    template <typename Coefficients>
+    struct FrameDecimator
+    {
+        static constexpr int HISTORY = Coefficients::NUM_TAPS;
+
+        void reset()
+        {
+            for (auto& frame : history)
+                frame.fill (0.0f);
+            writePos = 0;
+        }
+
+        /** Two frames in, one out; the output is taken on the first of the pair. */
+        void process (const Frame& first, const Frame& second, Frame& out)
+        {
+            push (first);
+
+            const auto& h = Coefficients::get().even;
+            const Frame* x = history.data() + writePos;   // x[HISTORY - 1] newest
+
+            Frame acc;
+            const Frame& centre = x[HISTORY - 1 - Coefficients::CENTRE];
+            for (size_t c = 0; c < N; ++c)
+                acc[c] = 0.5f * centre[c];
+            for (int j = 0; j < Coefficients::NUM_EVEN; ++j)
+            {
+                const float hj = h[static_cast<size_t> (j)];
+                const Frame& xj = x[HISTORY - 1 - 2 * j];
+                for (size_t c = 0; c < N; ++c)
+                    acc[c] += hj * xj[c];
+            }
+
+            push (second);
+            out = acc;
+        }
+
+        void push (const Frame& frame)
+        {
+            history[static_cast<size_t> (writePos)] = frame;
+            history[static_cast<size_t> (writePos + HISTORY)] = frame;
+            if (++writePos == HISTORY)
+                writePos = 0;
+        }
+
+        std::array<Frame, 2 * HISTORY> history {};
+        int writePos = 0;
+    };
+
+    int numStages = 0;
+    FrameInterpolator<HalfbandCoefficients> firstInterpolator;
+    FrameDecimator<HalfbandCoefficients> firstDecimator;
+    std::array<FrameInterpolator<ShortHalfbandCoefficients>, MAX_STAGES - 1> innerInterpolators;
+    std::array<FrameDecimator<ShortHalfbandCoefficients>, MAX_STAGES - 1> innerDecimators;
+};
+
+}  // namespace DSP
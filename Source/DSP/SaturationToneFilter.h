@@ -83,6 +83,9 @@ public:
         }
     }
 
+    /** False at (near) flat tone, where process() passes input through. */
+    bool isEnabled() const { return isActive; }
+
     void reset()
     {
         lpState = 0.0f;
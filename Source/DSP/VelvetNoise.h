@@ -1,7 +1,9 @@
 #pragma once
 
 #include <juce_core/juce_core.h>
+#include "DSP/PulseSequenceCache.h"
 #include <vector>
+#include <memory>
 #include <cstdint>
 #include <cmath>
 #include <algorithm>
@@ -12,9 +14,11 @@ namespace DSP
 /**
  * Optimised Velvet Noise (OVN) for early reflections.
  *
- * Uses a ring buffer so that pulses whose position exceeds the
- * current block size are still correctly applied across block
- * boundaries.  Energy is RMS-normalised for unity gain.
+ * The generated sequence (PulseSequence) is immutable and can be
+ * shared between any number of instances and threads.  All mutable
+ * convolution history lives in a per-channel ConvolverState, so
+ * convolve() never writes through a shared object.
+ * Energy is RMS-normalised for unity gain.
  */
 class VelvetNoise
 {
@@ -25,105 +29,192 @@ public:
         float sign;
     };
 
-    VelvetNoise() = default;
-
-    void generate (double sampleRate, float durationMs,
-                   float density, uint32_t seed)
+    /** Immutable pulse positions, signs, envelopes and gain. */
+    struct PulseSequence
     {
-        sequenceLength = static_cast<int> (sampleRate * durationMs * 0.001f);
-        int gridSize = std::max (1, static_cast<int> (sampleRate / density));
-        int numPulses = sequenceLength / gridSize;
+        std::vector<Pulse> pulses;
+        std::vector<float> envelopes;
+        std::vector<float> coefficients;   // sign * envelope * normGain
+        int sequenceLength = 0;
+        float decayRate = 0.0f;
+        float normGain = 1.0f;
+
+        static std::shared_ptr<const PulseSequence> generate (double sampleRate,
+                                                              float durationMs,
+                                                              float density,
+                                                              uint32_t seed)
+        {
+            auto seq = std::make_shared<PulseSequence>();
 
-        pulses.clear();
-        pulses.reserve (static_cast<size_t> (numPulses));
+            seq->sequenceLength = static_cast<int> (sampleRate * durationMs * 0.001f);
+            int gridSize = std::max (1, static_cast<int> (sampleRate / density));
+            int numPulses = seq->sequenceLength / gridSize;
 
-        uint32_t rng = seed;
-        for (int m = 0; m < numPulses; ++m)
-        {
-            rng = rng * 1664525u + 1013904223u;
-            int pos = m * gridSize
-                    + static_cast<int> (rng % static_cast<uint32_t> (gridSize));
+            seq->pulses.reserve (static_cast<size_t> (numPulses));
+
+            uint32_t rng = seed;
+            for (int m = 0; m < numPulses; ++m)
+            {
+                rng = rng * 1664525u + 1013904223u;
+                int pos = m * gridSize
+                        + static_cast<int> (rng % static_cast<uint32_t> (gridSize));
+
+                rng = rng * 1664525u + 1013904223u;
+                float sign = (rng & 0x80000000u) ? -1.0f : 1.0f;
+
+                if (pos < seq->sequenceLength)
+                    seq->pulses.push_back ({ pos, sign });
+            }
+
+            // -60 dB decay over the full duration
+            seq->decayRate = -3.0f * std::log (10.0f)
+                           / std::max (1.0f, static_cast<float> (seq->sequenceLength));
 
-            rng = rng * 1664525u + 1013904223u;
-            float sign = (rng & 0x80000000u) ? -1.0f : 1.0f;
+            // Pre-compute envelopes and RMS normalisation
+            float energySum = 0.0f;
+            seq->envelopes.resize (seq->pulses.size());
+            for (size_t k = 0; k < seq->pulses.size(); ++k)
+            {
+                float env = std::exp (seq->decayRate
+                                      * static_cast<float> (seq->pulses[k].position));
+                seq->envelopes[k] = env;
+                energySum += env * env;
+            }
+            seq->normGain = (energySum > 1.0e-6f) ? (1.0f / std::sqrt (energySum)) : 1.0f;
+
+            seq->coefficients.resize (seq->pulses.size());
+            for (size_t k = 0; k < seq->pulses.size(); ++k)
+                seq->coefficients[k] = seq->pulses[k].sign * seq->envelopes[k] * seq->normGain;
 
-            if (pos < sequenceLength)
-                pulses.push_back ({ pos, sign });
+            return seq;
         }
 
-        // -60 dB decay over the full duration
-        decayRate = -3.0f * std::log (10.0f)
-                  / std::max (1.0f, static_cast<float> (sequenceLength));
+        /** Same as generate(), but shared through the process-wide cache. */
+        static std::shared_ptr<const PulseSequence> getShared (double sampleRate,
+                                                               float durationMs,
+                                                               float density,
+                                                               uint32_t seed)
+        {
+            return PulseSequenceCache<PulseSequence>::getInstance().getOrCreate (
+                { sampleRate, seed, density, durationMs },
+                [&] { return generate (sampleRate, durationMs, density, seed); });
+        }
+    };
 
-        // Pre-compute envelopes and RMS normalisation
-        float energySum = 0.0f;
-        envelopes.resize (pulses.size());
-        for (size_t k = 0; k < pulses.size(); ++k)
+    /**
+     * Per-channel input history.  One instance per channel / per thread;
+     * sized in prepare() so convolve() never allocates.
+     */
+    class ConvolverState
+    {
+    public:
+        void prepare (int sequenceLength, int maxBlockSize)
         {
-            float env = std::exp (decayRate * static_cast<float> (pulses[k].position));
-            envelopes[k] = env;
-            energySum += env * env;
+            ringSize = std::max (1, sequenceLength + std::max (1, maxBlockSize));
+            ringBuffer.assign (static_cast<size_t> (ringSize), 0.0f);
+            writePos = 0;
         }
-        normGain = (energySum > 1.0e-6f) ? (1.0f / std::sqrt (energySum)) : 1.0f;
 
-        // Allocate ring buffer
-        ringSize = sequenceLength + 256;
-        ringBuffer.assign (static_cast<size_t> (ringSize), 0.0f);
-        ringWritePos = 0;
-    }
+        void reset()
+        {
+            std::fill (ringBuffer.begin(), ringBuffer.end(), 0.0f);
+            writePos = 0;
+        }
+
+        int getCapacity() const { return ringSize; }
 
-    void convolve (const float* input, float* output,
-                   int numSamples, float gain) const
+    private:
+        friend class VelvetNoise;
+
+        std::vector<float> ringBuffer;
+        int ringSize = 0;
+        int writePos = 0;
+    };
+
+    VelvetNoise() = default;
+
+    /**
+     * Sparse FIR convolution of one block.
+     * Only 'state' is written; 'sequence' may be shared freely.
+     * numSamples must not exceed the maxBlockSize given to state.prepare().
+     */
+    static void convolve (const PulseSequence& sequence, ConvolverState& state,
+                          const float* input, float* output,
+                          int numSamples, float gain)
     {
-        auto* ring = const_cast<float*> (ringBuffer.data());
-        int wp = ringWritePos;
+        auto* ring = state.ringBuffer.data();
+        const int ringSize = state.ringSize;
+        const int startPos = state.writePos;
 
         // Write input into ring buffer
+        int wp = startPos;
         for (int n = 0; n < numSamples; ++n)
         {
             ring[wp] = input[n];
-            wp = (wp + 1) % ringSize;
+            if (++wp == ringSize)
+                wp = 0;
         }
 
         // Clear output
-        for (int n = 0; n < numSamples; ++n)
-            output[n] = 0.0f;
+        std::fill (output, output + numSamples, 0.0f);
 
         // Sparse FIR convolution via ring buffer
-        for (size_t k = 0; k < pulses.size(); ++k)
+        for (size_t k = 0; k < sequence.pulses.size(); ++k)
         {
-            float coeff = pulses[k].sign * gain * envelopes[k] * normGain;
+            const float coeff = sequence.coefficients[k] * gain;
             if (std::abs (coeff) < 1.0e-10f)
                 continue;
 
-            int pulsePos = pulses[k].position;
+            int readIdx = startPos - sequence.pulses[k].position;
+            if (readIdx < 0)
+                readIdx += ringSize;
 
             for (int n = 0; n < numSamples; ++n)
             {
-                int readIdx = (ringWritePos + n - pulsePos);
-                // Ensure positive modulo
-                readIdx = ((readIdx % ringSize) + ringSize) % ringSize;
                 output[n] += coeff * ring[readIdx];
+                if (++readIdx == ringSize)
+                    readIdx = 0;
             }
         }
 
-        // Advance write position
-        const_cast<int&> (ringWritePos) = wp;
+        state.writePos = wp;
     }
 
-    int getSequenceLength() const { return sequenceLength; }
-    const std::vector<Pulse>& getPulses() const { return pulses; }
+    /** Fetches (or generates) the shared sequence and sizes the channel state for it. */
+    void generate (double sampleRate, float durationMs,
+                   float density, uint32_t seed, int maxBlockSize)
+    {
+        setSequence (PulseSequence::getShared (sampleRate, durationMs, density, seed),
+                     maxBlockSize);
+    }
+
+    /** Adopts a (possibly shared) sequence and resizes the channel state. */
+    void setSequence (std::shared_ptr<const PulseSequence> newSequence, int maxBlockSize)
+    {
+        sequence = std::move (newSequence);
+        state.prepare (sequence != nullptr ? sequence->sequenceLength : 0, maxBlockSize);
+    }
+
+    void convolve (const float* input, float* output, int numSamples, float gain)
+    {
+        if (sequence == nullptr)
+        {
+            std::fill (output, output + numSamples, 0.0f);
+            return;
+        }
+
+        convolve (*sequence, state, input, output, numSamples, gain);
+    }
+
+    void reset() { state.reset(); }
+
+    int getSequenceLength() const { return sequence != nullptr ? sequence->sequenceLength : 0; }
+
+    const std::shared_ptr<const PulseSequence>& getSequence() const { return sequence; }
 
 private:
-    std::vector<Pulse> pulses;
-    std::vector<float> envelopes;
-    int sequenceLength = 0;
-    float decayRate = 0.0f;
-    float normGain = 1.0f;
-
-    mutable std::vector<float> ringBuffer;
-    mutable int ringWritePos = 0;
-    int ringSize = 0;
+    std::shared_ptr<const PulseSequence> sequence;
+    ConvolverState state;
 };
 
 }  // namespace DSP
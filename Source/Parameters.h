@@ -13,22 +13,36 @@ inline constexpr const char* LATE_LEVEL_DB      = "late_level_db";
 inline constexpr const char* ROOM_SIZE          = "room_size";
 inline constexpr const char* STEREO_WIDTH       = "stereo_width";
 inline constexpr const char* OVERSAMPLING       = "oversampling_factor";
+inline constexpr const char* OVERSAMPLING_FILTER = "oversampling_filter";
 
 inline constexpr const char* LOW_RT60_S         = "low_rt60_s";
 inline constexpr const char* HIGH_RT60_S        = "high_rt60_s";
 inline constexpr const char* HF_DAMPING         = "hf_damping";
 inline constexpr const char* DIFFUSION          = "diffusion";
 inline constexpr const char* DECAY_SHAPE        = "decay_shape";
+inline constexpr const char* FDN_ROUTING        = "fdn_routing";
+inline constexpr const char* ER_LENGTH_MS       = "er_length_ms";
+inline constexpr const char* ER_DENSITY         = "er_density";
 
 inline constexpr const char* SAT_AMOUNT         = "sat_amount";
 inline constexpr const char* SAT_DRIVE_DB       = "sat_drive_db";
 inline constexpr const char* SAT_TYPE           = "sat_type";
 inline constexpr const char* SAT_TONE           = "sat_tone";
 inline constexpr const char* SAT_ASYMMETRY      = "sat_asymmetry";
+inline constexpr const char* SAT_ANTIALIAS      = "sat_antialias";
+inline constexpr const char* SAT_OVERSAMPLING   = "sat_oversampling";
 
 inline constexpr const char* MOD_DEPTH          = "mod_depth";
 inline constexpr const char* MOD_RATE_HZ        = "mod_rate_hz";
 
+// Quality / CPU switches
+inline constexpr const char* DVN_HALF_RATE      = "dvn_half_rate";
+inline constexpr const char* OVERSAMPLING_AUTO  = "oversampling_auto";
+inline constexpr const char* OVERSAMPLING_NONLINEAR_ONLY = "oversampling_nonlinear_only";
+inline constexpr const char* OUTPUT_CLIP_ADAA   = "output_clip_adaa";
+inline constexpr const char* PARALLEL_LAYERS    = "parallel_layers";
+inline constexpr const char* DVN_PIPELINED      = "dvn_pipelined";
+
 // Debug bypass switches
 inline constexpr const char* BYPASS_EARLY       = "bypass_early";
 inline constexpr const char* BYPASS_FDN         = "bypass_fdn";
@@ -42,7 +56,7 @@ inline juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout
 {
     std::vector<std::unique_ptr<juce::RangedAudioParameter>> params;
 
-    // ---- Main controls (7) ----
+    // ---- Main controls (8) ----
     params.push_back (std::make_unique<juce::AudioParameterFloat> (
         juce::ParameterID { DRY_WET, 1 },
         "Dry/Wet Mix",
@@ -84,13 +98,26 @@ inline juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout
         70.0f,
         juce::AudioParameterFloatAttributes().withLabel ("%")));
 
+    // The reported latency is that of 16x with the chosen filter at every
+    // setting, Off included, so switching factors never changes it.
+    // Powers of two only: juce::dsp::Oversampling cascades 2x halfband
+    // stages, and 3x / 6x would need a separate polyphase resampler
     params.push_back (std::make_unique<juce::AudioParameterChoice> (
         juce::ParameterID { OVERSAMPLING, 1 },
         "Oversampling",
-        juce::StringArray { "Off", "2x", "4x" },
+        juce::StringArray { "Off", "2x", "4x", "8x", "16x" },
+        1));
+
+    // Latency mode: low-latency IIR for tracking, linear-phase FIR for mixdown.
+    // Changing it changes the latency: the FDN fades out over 50 ms and
+    // restarts from silence, so the current reverb tail is cut
+    params.push_back (std::make_unique<juce::AudioParameterChoice> (
+        juce::ParameterID { OVERSAMPLING_FILTER, 1 },
+        "Oversampling Filter",
+        juce::StringArray { "Low Latency IIR", "IIR", "Linear Phase FIR" },
         1));
 
-    // ---- Reverb character (5) ----
+    // ---- Reverb character (6) ----
     // *** RT60 ranges extended for long violin sustain ***
     params.push_back (std::make_unique<juce::AudioParameterFloat> (
         juce::ParameterID { LOW_RT60_S, 1 },
@@ -127,7 +154,30 @@ inline juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout
         40.0f,
         juce::AudioParameterFloatAttributes().withLabel ("%")));
 
-    // ---- Saturation (5) ----
+    // How L/R feed and read the FDN lines (FDNReverb::Routing, same order).
+    // Stereo, the default, is the cheap one: no routing mat-vec per sample
+    params.push_back (std::make_unique<juce::AudioParameterChoice> (
+        juce::ParameterID { FDN_ROUTING, 1 },
+        "FDN Routing",
+        juce::StringArray { "Stereo", "Mid/Side", "Mono In" },
+        0));
+
+    // ---- Early reflection pattern (2) ----
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (
+        juce::ParameterID { ER_LENGTH_MS, 1 },
+        "Early Length",
+        juce::NormalisableRange<float> (10.0f, 80.0f, 1.0f),
+        30.0f,
+        juce::AudioParameterFloatAttributes().withLabel ("ms")));
+
+    params.push_back (std::make_unique<juce::AudioParameterFloat> (
+        juce::ParameterID { ER_DENSITY, 1 },
+        "Early Density",
+        juce::NormalisableRange<float> (500.0f, 4000.0f, 10.0f),
+        2000.0f,
+        juce::AudioParameterFloatAttributes().withLabel ("/s")));
+
+    // ---- Saturation (7) ----
     params.push_back (std::make_unique<juce::AudioParameterFloat> (
         juce::ParameterID { SAT_AMOUNT, 1 },
         "Saturation Amount",
@@ -162,6 +212,20 @@ inline juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout
         0.0f,
         juce::AudioParameterFloatAttributes().withLabel ("%")));
 
+    params.push_back (std::make_unique<juce::AudioParameterChoice> (
+        juce::ParameterID { SAT_ANTIALIAS, 1 },
+        "Saturation Anti-Aliasing",
+        juce::StringArray { "Off", "ADAA 1", "ADAA 2" },
+        0));
+
+    // Local oversampling of the saturation stage only (inside the FDN loop);
+    // halfband stages again, hence powers of two
+    params.push_back (std::make_unique<juce::AudioParameterChoice> (
+        juce::ParameterID { SAT_OVERSAMPLING, 1 },
+        "Saturation Oversampling",
+        juce::StringArray { "Off", "2x", "4x" },
+        0));
+
     // ---- Modulation (2) ----
     params.push_back (std::make_unique<juce::AudioParameterFloat> (
         juce::ParameterID { MOD_DEPTH, 1 },
@@ -177,6 +241,36 @@ inline juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout
         0.5f,
         juce::AudioParameterFloatAttributes().withLabel ("Hz")));
 
+    // ---- Quality / CPU switches (6) ----
+    params.push_back (std::make_unique<juce::AudioParameterBool> (
+        juce::ParameterID { DVN_HALF_RATE, 1 },
+        "DVN Half Rate", false));
+
+    params.push_back (std::make_unique<juce::AudioParameterBool> (
+        juce::ParameterID { OVERSAMPLING_AUTO, 1 },
+        "Auto Oversampling", false));
+
+    // FDN loop at base rate; the Oversampling factor goes to saturation + limiter only
+    params.push_back (std::make_unique<juce::AudioParameterBool> (
+        juce::ParameterID { OVERSAMPLING_NONLINEAR_ONLY, 1 },
+        "Oversample Nonlinear Only", false));
+
+    // Antiderivative anti-aliasing on the output soft clip
+    params.push_back (std::make_unique<juce::AudioParameterBool> (
+        juce::ParameterID { OUTPUT_CLIP_ADAA, 1 },
+        "Output Clip ADAA", false));
+
+    // ER and DVN on a helper thread alongside the FDN (large blocks only)
+    params.push_back (std::make_unique<juce::AudioParameterBool> (
+        juce::ParameterID { PARALLEL_LAYERS, 1 },
+        "Parallel Layers", false));
+
+    // DVN of each block on a helper thread during the next one (+1 block latency).
+    // Takes effect when the host next prepares playback, never mid-stream
+    params.push_back (std::make_unique<juce::AudioParameterBool> (
+        juce::ParameterID { DVN_PIPELINED, 1 },
+        "DVN Pipelined", false));
+
     // ---- Debug bypass switches (7) ----
     params.push_back (std::make_unique<juce::AudioParameterBool> (
         juce::ParameterID { BYPASS_EARLY, 1 },
@@ -36,6 +36,8 @@ WetStringReverbEditor::WetStringReverbEditor (WetStringReverbProcessor& p)
     setupKnob (hfDampKnob,      Parameters::HF_DAMPING,     "HF Damp",     reverbColour);
     setupKnob (diffusionKnob,   Parameters::DIFFUSION,      "Diffusion",   reverbColour);
     setupKnob (decayShapeKnob,  Parameters::DECAY_SHAPE,    "Decay Shape", reverbColour);
+    setupKnob (erLengthKnob,    Parameters::ER_LENGTH_MS,   "ER Length",   reverbColour);
+    setupKnob (erDensityKnob,   Parameters::ER_DENSITY,     "ER Density",  reverbColour);
 
     // ---- SATURATION knobs ----
     setupKnob (satAmountKnob,    Parameters::SAT_AMOUNT,    "Amount",      satColour);
@@ -49,7 +51,11 @@ WetStringReverbEditor::WetStringReverbEditor (WetStringReverbProcessor& p)
 
     // ---- Combo boxes ----
     setupChoice (oversamplingChoice, Parameters::OVERSAMPLING, "OS");
+    setupChoice (oversamplingFilterChoice, Parameters::OVERSAMPLING_FILTER, "OS Filter");
+    setupChoice (fdnRoutingChoice,   Parameters::FDN_ROUTING,  "Routing");
     setupChoice (satTypeChoice,      Parameters::SAT_TYPE,     "Type");
+    setupChoice (satAntiAliasChoice, Parameters::SAT_ANTIALIAS, "Anti-Alias");
+    setupChoice (satOversamplingChoice, Parameters::SAT_OVERSAMPLING, "Sat OS");
 
     // ---- Bypass toggles ----
     setupToggle (bypassEarly,       Parameters::BYPASS_EARLY,        "Early");
@@ -60,6 +66,14 @@ WetStringReverbEditor::WetStringReverbEditor (WetStringReverbProcessor& p)
     setupToggle (bypassAttenFilter, Parameters::BYPASS_ATTEN_FILTER, "Atten Filt");
     setupToggle (bypassModulation,  Parameters::BYPASS_MODULATION,   "Modulation");
 
+    // ---- Quality toggles ----
+    setupToggle (dvnHalfRateToggle, Parameters::DVN_HALF_RATE,       "DVN 1/2");
+    setupToggle (autoOversamplingToggle, Parameters::OVERSAMPLING_AUTO, "Auto OS");
+    setupToggle (nonlinearOversamplingToggle, Parameters::OVERSAMPLING_NONLINEAR_ONLY, "NL OS");
+    setupToggle (clipAdaaToggle, Parameters::OUTPUT_CLIP_ADAA, "Clip AA");
+    setupToggle (parallelLayersToggle, Parameters::PARALLEL_LAYERS, "Parallel");
+    setupToggle (dvnPipelinedToggle, Parameters::DVN_PIPELINED, "DVN Pipe");
+
     // ---- Buttons ----
     addAndMakeVisible (saveButton);
     addAndMakeVisible (loadButton);
@@ -197,7 +211,7 @@ void WetStringReverbEditor::resized()
     // ---- Row 1: MAIN  (y=48..162, content starts at y=66) ----
     {
         constexpr int rowY = 66, rowH = 90;
-        int n = 7;
+        int n = 8;
         int cellW = usableW / n;
         int x0 = pad;
         placeKnob   (dryWetKnob,         x0 + cellW * 0, rowY, cellW, rowH);
@@ -207,12 +221,13 @@ void WetStringReverbEditor::resized()
         placeKnob   (roomSizeKnob,       x0 + cellW * 4, rowY, cellW, rowH);
         placeKnob   (widthKnob,          x0 + cellW * 5, rowY, cellW, rowH);
         placeChoice (oversamplingChoice,  x0 + cellW * 6, rowY, cellW, rowH);
+        placeChoice (oversamplingFilterChoice, x0 + cellW * 7, rowY, cellW, rowH);
     }
 
     // ---- Row 2: REVERB  (y=166..280, content at y=184) ----
     {
         constexpr int rowY = 184, rowH = 90;
-        int n = 5;
+        int n = 8;
         int cellW = usableW / n;
         int x0 = pad;
         placeKnob (lowRT60Knob,    x0 + cellW * 0, rowY, cellW, rowH);
@@ -220,12 +235,15 @@ void WetStringReverbEditor::resized()
         placeKnob (hfDampKnob,     x0 + cellW * 2, rowY, cellW, rowH);
         placeKnob (diffusionKnob,  x0 + cellW * 3, rowY, cellW, rowH);
         placeKnob (decayShapeKnob, x0 + cellW * 4, rowY, cellW, rowH);
+        placeKnob (erLengthKnob,   x0 + cellW * 5, rowY, cellW, rowH);
+        placeKnob (erDensityKnob,  x0 + cellW * 6, rowY, cellW, rowH);
+        placeChoice (fdnRoutingChoice, x0 + cellW * 7, rowY, cellW, rowH);
     }
 
     // ---- Row 3: SATURATION  (y=284..398, content at y=302) ----
     {
         constexpr int rowY = 302, rowH = 90;
-        int n = 5;
+        int n = 7;
         int cellW = usableW / n;
         int x0 = pad;
         placeKnob   (satAmountKnob,    x0 + cellW * 0, rowY, cellW, rowH);
@@ -233,6 +251,8 @@ void WetStringReverbEditor::resized()
         placeChoice (satTypeChoice,     x0 + cellW * 2, rowY, cellW, rowH);
         placeKnob   (satToneKnob,      x0 + cellW * 3, rowY, cellW, rowH);
         placeKnob   (satAsymmetryKnob, x0 + cellW * 4, rowY, cellW, rowH);
+        placeChoice (satAntiAliasChoice, x0 + cellW * 5, rowY, cellW, rowH);
+        placeChoice (satOversamplingChoice, x0 + cellW * 6, rowY, cellW, rowH);
     }
 
     // ---- Row 4: MOD + BYPASS  (y=402..516, content at y=420) ----
@@ -245,22 +265,28 @@ void WetStringReverbEditor::resized()
         placeKnob (modDepthKnob, x0,            rowY, modCellW, rowH);
         placeKnob (modRateKnob,  x0 + modCellW, rowY, modCellW, rowH);
 
-        // Bypass toggles (right) — 2 rows: 4 top, 3 bottom
+        // Bypass / quality toggles (right) — 2 rows: 7 top, 6 bottom
         int toggleX = x0 + modCellW * 2 + 16;
         int toggleAreaW = getWidth() - pad - toggleX;
         int halfH = rowH / 2;
 
-        int topW = toggleAreaW / 4;
-        int botW = toggleAreaW / 3;
+        int topW = toggleAreaW / 7;
+        int botW = toggleAreaW / 6;
 
         bypassEarly     .toggle.setBounds (toggleX + topW * 0, rowY,          topW, halfH);
         bypassFDN       .toggle.setBounds (toggleX + topW * 1, rowY,          topW, halfH);
         bypassDVN       .toggle.setBounds (toggleX + topW * 2, rowY,          topW, halfH);
         bypassSaturation.toggle.setBounds (toggleX + topW * 3, rowY,          topW, halfH);
+        nonlinearOversamplingToggle.toggle.setBounds (toggleX + topW * 4, rowY, topW, halfH);
+        clipAdaaToggle  .toggle.setBounds (toggleX + topW * 5, rowY,          topW, halfH);
+        dvnPipelinedToggle.toggle.setBounds (toggleX + topW * 6, rowY,        topW, halfH);
 
         bypassToneFilter .toggle.setBounds (toggleX + botW * 0, rowY + halfH, botW, halfH);
         bypassAttenFilter.toggle.setBounds (toggleX + botW * 1, rowY + halfH, botW, halfH);
         bypassModulation .toggle.setBounds (toggleX + botW * 2, rowY + halfH, botW, halfH);
+        dvnHalfRateToggle.toggle.setBounds (toggleX + botW * 3, rowY + halfH, botW, halfH);
+        autoOversamplingToggle.toggle.setBounds (toggleX + botW * 4, rowY + halfH, botW, halfH);
+        parallelLayersToggle.toggle.setBounds (toggleX + botW * 5, rowY + halfH, botW, halfH);
     }
 }
 
@@ -46,14 +46,16 @@ private:
     // ---- MAIN ----
     KnobWithLabel dryWetKnob, preDelayKnob, earlyLevelKnob, lateLevelKnob,
                   roomSizeKnob, widthKnob;
-    ChoiceWithLabel oversamplingChoice;
+    ChoiceWithLabel oversamplingChoice, oversamplingFilterChoice;
 
     // ---- REVERB ----
-    KnobWithLabel lowRT60Knob, highRT60Knob, hfDampKnob, diffusionKnob, decayShapeKnob;
+    KnobWithLabel lowRT60Knob, highRT60Knob, hfDampKnob, diffusionKnob, decayShapeKnob,
+                  erLengthKnob, erDensityKnob;
+    ChoiceWithLabel fdnRoutingChoice;
 
     // ---- SATURATION ----
     KnobWithLabel satAmountKnob, satDriveKnob, satToneKnob, satAsymmetryKnob;
-    ChoiceWithLabel satTypeChoice;
+    ChoiceWithLabel satTypeChoice, satAntiAliasChoice, satOversamplingChoice;
 
     // ---- MODULATION ----
     KnobWithLabel modDepthKnob, modRateKnob;
@@ -62,6 +64,10 @@ private:
     ToggleWithLabel bypassEarly, bypassFDN, bypassDVN, bypassSaturation,
                     bypassToneFilter, bypassAttenFilter, bypassModulation;
 
+    // ---- QUALITY TOGGLES ----
+    ToggleWithLabel dvnHalfRateToggle, autoOversamplingToggle, nonlinearOversamplingToggle, clipAdaaToggle,
+                    parallelLayersToggle, dvnPipelinedToggle;
+
     // ---- Buttons ----
     juce::TextButton saveButton  { "Save" };
     juce::TextButton loadButton  { "Load" };
@@ -14,22 +14,35 @@ WetStringReverbProcessor::WetStringReverbProcessor()
     roomSizeParam     = apvts.getRawParameterValue (Parameters::ROOM_SIZE);
     stereoWidthParam  = apvts.getRawParameterValue (Parameters::STEREO_WIDTH);
     oversamplingParam = apvts.getRawParameterValue (Parameters::OVERSAMPLING);
+    oversamplingFilterParam = apvts.getRawParameterValue (Parameters::OVERSAMPLING_FILTER);
 
     lowRT60Param      = apvts.getRawParameterValue (Parameters::LOW_RT60_S);
     highRT60Param     = apvts.getRawParameterValue (Parameters::HIGH_RT60_S);
     hfDampingParam    = apvts.getRawParameterValue (Parameters::HF_DAMPING);
     diffusionParam    = apvts.getRawParameterValue (Parameters::DIFFUSION);
     decayShapeParam   = apvts.getRawParameterValue (Parameters::DECAY_SHAPE);
+    fdnRoutingParam   = apvts.getRawParameterValue (Parameters::FDN_ROUTING);
+    erLengthParam     = apvts.getRawParameterValue (Parameters::ER_LENGTH_MS);
+    erDensityParam    = apvts.getRawParameterValue (Parameters::ER_DENSITY);
 
     satAmountParam    = apvts.getRawParameterValue (Parameters::SAT_AMOUNT);
     satDriveParam     = apvts.getRawParameterValue (Parameters::SAT_DRIVE_DB);
     satTypeParam      = apvts.getRawParameterValue (Parameters::SAT_TYPE);
     satToneParam      = apvts.getRawParameterValue (Parameters::SAT_TONE);
     satAsymmetryParam = apvts.getRawParameterValue (Parameters::SAT_ASYMMETRY);
+    satAntiAliasParam = apvts.getRawParameterValue (Parameters::SAT_ANTIALIAS);
+    satOversamplingParam = apvts.getRawParameterValue (Parameters::SAT_OVERSAMPLING);
 
     modDepthParam     = apvts.getRawParameterValue (Parameters::MOD_DEPTH);
     modRateParam      = apvts.getRawParameterValue (Parameters::MOD_RATE_HZ);
 
+    dvnHalfRateParam  = apvts.getRawParameterValue (Parameters::DVN_HALF_RATE);
+    oversamplingAutoParam = apvts.getRawParameterValue (Parameters::OVERSAMPLING_AUTO);
+    oversamplingNonlinearOnlyParam = apvts.getRawParameterValue (Parameters::OVERSAMPLING_NONLINEAR_ONLY);
+    outputClipAdaaParam = apvts.getRawParameterValue (Parameters::OUTPUT_CLIP_ADAA);
+    parallelLayersParam = apvts.getRawParameterValue (Parameters::PARALLEL_LAYERS);
+    dvnPipelinedParam   = apvts.getRawParameterValue (Parameters::DVN_PIPELINED);
+
     bypassEarlyParam      = apvts.getRawParameterValue (Parameters::BYPASS_EARLY);
     bypassFDNParam        = apvts.getRawParameterValue (Parameters::BYPASS_FDN);
     bypassDVNParam        = apvts.getRawParameterValue (Parameters::BYPASS_DVN);
@@ -37,6 +50,28 @@ WetStringReverbProcessor::WetStringReverbProcessor()
     bypassToneFilterParam = apvts.getRawParameterValue (Parameters::BYPASS_TONE_FILTER);
     bypassAttenFilterParam = apvts.getRawParameterValue (Parameters::BYPASS_ATTEN_FILTER);
     bypassModulationParam = apvts.getRawParameterValue (Parameters::BYPASS_MODULATION);
+
+    // Oversampler latency depends on factor and filter only, so unbuilt
+    // paths can be padded for without preparing them
+    for (int factor = 0; factor < kNumOversamplingFactors; ++factor)
+        for (int filter = 0; filter < DSP::OversamplingManager::kNumFilters; ++filter)
+            fdnPathLatencies[static_cast<size_t> (factor)][static_cast<size_t> (filter)] =
+                DSP::OversamplingManager::computeLatencyInSamples (
+                    2, factor, static_cast<DSP::OversamplingManager::Filter> (filter));
+
+    // The alignment delays are sized for the longest of them
+    for (const auto& latencies : fdnPathLatencies)
+        for (float pathLatency : latencies)
+            maxOversamplingLatency = std::max (maxOversamplingLatency, static_cast<int> (std::lround (pathLatency)));
+}
+
+WetStringReverbProcessor::~WetStringReverbProcessor()
+{
+    cancelPendingUpdate();
+    layerWorkersRunning.store (false);
+    layerWorkers.stop();
+    dvnPipelineWorker.wait();
+    dvnPipelineWorker.stop();
 }
 
 void WetStringReverbProcessor::initAllSmoothedValues (double sampleRate)
@@ -49,7 +84,6 @@ void WetStringReverbProcessor::initAllSmoothedValues (double sampleRate)
     };
 
     init (smoothDryWet,       dryWetParam->load());
-    init (smoothPreDelay,     preDelayParam->load());
     init (smoothEarlyLevel,   earlyLevelParam->load());
     init (smoothLateLevel,    lateLevelParam->load());
     init (smoothRoomSize,     roomSizeParam->load());
@@ -68,62 +102,448 @@ void WetStringReverbProcessor::initAllSmoothedValues (double sampleRate)
 
     init (smoothModDepth,     modDepthParam->load());
     init (smoothModRate,      modRateParam->load());
+
+    reverbMixer.setParameters (smoothDryWet.getCurrentValue(), smoothEarlyLevel.getCurrentValue(),
+                               smoothLateLevel.getCurrentValue(), smoothStereoWidth.getCurrentValue());
+    reverbMixer.reset();
 }
 
 void WetStringReverbProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
+    // A pipelined DVN job may still be using the state rebuilt below
+    dvnPipelineWorker.wait();
+
     currentSampleRate = sampleRate;
-    currentBlockSize = samplesPerBlock;
+    currentBlockSize = std::max (1, samplesPerBlock);
 
     initAllSmoothedValues (sampleRate);
 
-    juce::dsp::ProcessSpec spec { sampleRate,
-                                   static_cast<juce::uint32> (samplesPerBlock),
-                                   1 };
-    for (auto& pd : preDelayLine)
+    const uint32_t erSeeds[2] = { 0xDEADBEEFu, 0xCAFEBABEu };
+    const int maxPreDelaySamples = static_cast<int> (sampleRate * kMaxPreDelaySeconds) + 1;
+    cancelPendingUpdate();
+    erRegenerationPending.store (false);
+    oversamplingFilterRequest.store (-1);
+    earlyReflections.prepare (sampleRate, samplesPerBlock, erSeeds, 2, maxPreDelaySamples,
+                              erLengthParam->load(), erDensityParam->load());
+    preDelay.prepare (2, maxPreDelaySamples, samplesPerBlock,
+                      static_cast<int> (sampleRate * DSP::EarlyReflections::FADE_TIME_MS * 0.001f));
+    dryAlign.prepare (4, maxOversamplingLatency, currentBlockSize, 64);
+
+    prepareFdnPaths();
+
+    // Each tail picks the sparse or FFT engine from its estimated cost at
+    // this rate and block size; both render the same response
+    const auto dvnEngine = DSP::DarkVelvetNoise::Engine::automatic;
+    dvnTail[0].prepare (sampleRate, samplesPerBlock, 0xABCD1234u, dvnEngine);
+    dvnTail[1].prepare (sampleRate, samplesPerBlock, 0x5678EF01u, dvnEngine);
+
+    // Half-rate DVN option: same seeds, half the pulse-sample work.  The
+    // decimate + interpolate round trip delays it by 2 x LATENCY full-rate
+    // samples, i.e. LATENCY half-rate ones: its taps lead by that much so
+    // both rates line up with the FDN tail
+    const int halfBlockSize = samplesPerBlock / 2 + 1;
+    auto halfRateConfig = dvnTailHalfRate[0].getConfig();
+    halfRateConfig.leadSamples = DSP::HalfbandCoefficients::LATENCY;
+    for (auto& dvn : dvnTailHalfRate)
+        dvn.setConfig (halfRateConfig);
+    dvnTailHalfRate[0].prepare (sampleRate * 0.5, halfBlockSize, 0xABCD1234u, dvnEngine);
+    dvnTailHalfRate[1].prepare (sampleRate * 0.5, halfBlockSize, 0x5678EF01u, dvnEngine);
+    for (int ch = 0; ch < 2; ++ch)
     {
-        pd.reset();
-        pd.prepare (spec);
-        pd.setMaximumDelayInSamples (static_cast<int> (sampleRate * 0.1) + 1);
+        dvnDecimator[ch].reset();
+        dvnInterpolator[ch].reset();
     }
+    lastDvnHalfRate = dvnHalfRateParam->load() >= 0.5f;
 
-    earlyReflections[0].prepare (sampleRate, samplesPerBlock, 0xDEADBEEFu);
-    earlyReflections[1].prepare (sampleRate, samplesPerBlock, 0xCAFEBABEu);
-
-    int osFactor = static_cast<int> (oversamplingParam->load());
-    initializeOversampling (osFactor);
-
-    dvnTail[0].prepare (sampleRate, samplesPerBlock, 0xABCD1234u);
-    dvnTail[1].prepare (sampleRate, samplesPerBlock, 0x5678EF01u);
-
-    dryBuffer.setSize (2, samplesPerBlock);
     earlyBuffer.setSize (2, samplesPerBlock);
     fdnInputBuffer.setSize (2, samplesPerBlock);
     dvnBuffer.setSize (2, samplesPerBlock);
+    dvnHalfRateBuffer.setSize (4, halfBlockSize);
+    fdnTailBuffer.setSize (2, samplesPerBlock);
+    fdnPathBuffer.setSize (2, samplesPerBlock);
+    monoRightBuffer.setSize (1, samplesPerBlock);
+
+    // Pipelined DVN: one prepared block of delay on dry, ER and late.  The
+    // mode is only taken here, where the latency change is expected
+    pipelineAlign.prepare (6, currentBlockSize, currentBlockSize, 1);
+    dvnPipelineInput.setSize (2, currentBlockSize);
+    dvnPipelineOutput.setSize (2, currentBlockSize);
+    dvnPipelineRing.setSize (2, 2 * currentBlockSize);
+    setDvnPipelined (dvnPipelinedParam->load() >= 0.5f);
+
+    lastParallelLayers = parallelLayersParam->load() >= 0.5f;
+    updateWorkerThreads();
+
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        stages.early[ch]   = earlyBuffer.getWritePointer (ch);
+        stages.late[ch]    = fdnInputBuffer.getWritePointer (ch);
+        stages.dvn[ch]     = dvnBuffer.getWritePointer (ch);
+        stages.fdnTail[ch] = fdnTailBuffer.getWritePointer (ch);
+        stages.fdnPath[ch] = fdnPathBuffer.getWritePointer (ch);
+    }
+
+    // Not the audio thread: the host can have the new latency right away
+    reportPendingLatency();
+}
+
+void WetStringReverbProcessor::prepareFdnPaths()
+{
+    // The 1x path (auto oversampling, linear loop, nonlinear only) and the
+    // selected factor; the 8x/16x paths alone are tens of MB at high rates
+    const bool nonlinearOnly = oversamplingNonlinearOnlyParam->load() >= 0.5f;
+    const int selected = nonlinearOnly ? 0 : std::clamp (static_cast<int> (oversamplingParam->load()),
+                                                         0, kNumOversamplingFactors - 1);
+    fdnPathBuildRequests.store (0);
+    fdnPathReleaseRequests.store (0);
+
+    for (int factor = 0; factor < kNumOversamplingFactors; ++factor)
+    {
+        if (factor == 0 || factor == selected)
+        {
+            buildFdnPath (factor);
+        }
+        else
+        {
+            fdnPathReady[static_cast<size_t> (factor)].store (false);
+            fdnPaths[static_cast<size_t> (factor)].reset();
+        }
+    }
+
+    applyOversamplingFilter (static_cast<int> (oversamplingFilterParam->load()));
+
+    activeFdnPath = selected;
+}
+
+void WetStringReverbProcessor::buildFdnPath (int factor)
+{
+    auto path = std::make_unique<FdnPath>();
+    for (int filter = 0; filter < DSP::OversamplingManager::kNumFilters; ++filter)
+        path->oversamplers[static_cast<size_t> (filter)].prepare (
+            2, factor, currentSampleRate, currentBlockSize,
+            static_cast<DSP::OversamplingManager::Filter> (filter));
+
+    path->fdn.prepare (path->oversamplers[0].getOversampledRate (currentSampleRate),
+                       currentBlockSize * (1 << factor));
+    path->latencyAlign.prepare (2, maxOversamplingLatency, currentBlockSize, 64);
+
+    fdnPaths[static_cast<size_t> (factor)] = std::move (path);
+    fdnPathReady[static_cast<size_t> (factor)].store (true, std::memory_order_release);
+}
+
+int WetStringReverbProcessor::getNumBuiltFdnPaths() const
+{
+    int numBuilt = 0;
+    for (const auto& ready : fdnPathReady)
+        numBuilt += ready.load() ? 1 : 0;
+    return numBuilt;
+}
+
+void WetStringReverbProcessor::applyOversamplingFilter (int filter)
+{
+    activeOversamplingFilter = std::clamp (filter, 0, DSP::OversamplingManager::kNumFilters - 1);
+    const auto index = static_cast<size_t> (activeOversamplingFilter);
+
+    float maxLatency = 0.0f;
+    for (const auto& latencies : fdnPathLatencies)
+        maxLatency = std::max (maxLatency, latencies[index]);
+
+    // Report the worst case once; faster paths are padded up to it.  IIR
+    // latencies are fractional: rounding leaves each path within half a
+    // sample of the dry and ER, which are delayed by the whole amount.
+    const int commonLatency = static_cast<int> (std::lround (maxLatency));
+    jassert (commonLatency <= maxOversamplingLatency);
+    oversamplingLatency.store (commonLatency);
+    updateReportedLatency();
+
+    // Every built path starts empty with the new filters
+    for (int factor = 0; factor < kNumOversamplingFactors; ++factor)
+    {
+        const float pathLatency = fdnPathLatencies[static_cast<size_t> (factor)][index];
+        fdnPathAlignDelays[static_cast<size_t> (factor)] =
+            std::max (0, static_cast<int> (std::lround (static_cast<float> (commonLatency) - pathLatency)));
+
+        if (! fdnPathReady[static_cast<size_t> (factor)].load (std::memory_order_acquire))
+            continue;
+
+        auto& path = *fdnPaths[static_cast<size_t> (factor)];
+        path.fdn.reset();
+        for (auto& oversampler : path.oversamplers)
+            oversampler.reset();
+        path.latencyAlign.reset();
+        path.ringing = false;
+        path.quietSamples = 0;
+        path.ringingSamples = 0;
+        path.gain = 1.0f;
+    }
+}
+
+void WetStringReverbProcessor::requestOversamplingFilter (int filter)
+{
+    // Resetting every path (up to 16x delay lines) and the latency report
+    // belong on the message thread; an offline render may block it, and
+    // has no deadline, so it applies the change in place
+    if (isNonRealtime())
+    {
+        applyOversamplingFilter (filter);
+        return;
+    }
+
+    oversamplingFilterRequest.store (filter, std::memory_order_release);
+    triggerAsyncUpdate();
+}
+
+void WetStringReverbProcessor::selectFdnPath (int factor)
+{
+    factor = std::clamp (factor, 0, kNumOversamplingFactors - 1);
+    if (factor == activeFdnPath)
+        return;
+
+    // Offline the message thread may be blocked for the whole render, and
+    // there is no deadline to miss: build the path here
+    if (isNonRealtime() && ! fdnPathReady[static_cast<size_t> (factor)].load (std::memory_order_acquire))
+        buildFdnPath (factor);
+
+    // Not built yet: ask the message thread, keep the current path until then
+    if (! fdnPathReady[static_cast<size_t> (factor)].load (std::memory_order_acquire))
+    {
+        const uint32_t bit = 1u << factor;
+        if ((fdnPathBuildRequests.fetch_or (bit) & bit) == 0)
+            triggerAsyncUpdate();
+        return;
+    }
+
+    // The outgoing path keeps ringing on silence; a path that was still
+    // ringing simply takes new input again
+    auto& outgoing = *fdnPaths[static_cast<size_t> (activeFdnPath)];
+    outgoing.ringing = true;
+    outgoing.quietSamples = 0;
+    outgoing.ringingSamples = 0;
+
+    fdnPaths[static_cast<size_t> (factor)]->ringing = false;
+    activeFdnPath = factor;
+}
+
+void WetStringReverbProcessor::processFdnPath (int factor, float* const* io, int numSamples)
+{
+    auto& path = *fdnPaths[static_cast<size_t> (factor)];
+    juce::dsp::AudioBlock<float> block (io, 2, static_cast<size_t> (numSamples));
+    auto& oversampler = path.oversamplers[static_cast<size_t> (activeOversamplingFilter)];
+    auto oversampledBlock = oversampler.processSamplesUp (block);
+
+    path.fdn.processBlock (oversampledBlock.getChannelPointer (0),
+                           oversampledBlock.getChannelPointer (1),
+                           static_cast<int> (oversampledBlock.getNumSamples()));
+
+    oversampler.processSamplesDown (block);
+
+    const float* in[2] = { io[0], io[1] };
+    path.latencyAlign.process (in, io, numSamples, fdnPathAlignDelays[static_cast<size_t> (factor)]);
+
+    // Gain only moves while a long tail, or every path ahead of a filter
+    // change, is being faded out (or back in)
+    const bool fadeOut = oversamplingFilterChangePending
+                      || (path.ringing
+                          && path.ringingSamples >= static_cast<int> (currentSampleRate * kFdnTailMaxSeconds));
+    const float step = static_cast<float> (numSamples / (currentSampleRate * kFdnTailFadeSeconds));
+    const float startGain = path.gain;
+    path.gain = fadeOut ? std::max (0.0f, path.gain - step) : std::min (1.0f, path.gain + step);
+
+    if (startGain < 1.0f || path.gain < 1.0f)
+    {
+        const float gainStep = (path.gain - startGain) / static_cast<float> (numSamples);
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < numSamples; ++i)
+                io[ch][i] *= startGain + gainStep * static_cast<float> (i);
+    }
+
+    if (! path.ringing)
+        return;
+
+    float peak = 0.0f;
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < numSamples; ++i)
+            peak = std::max (peak, std::abs (io[ch][i]));
+
+    path.ringingSamples += numSamples;
+    path.quietSamples = peak < kFdnTailSilence ? path.quietSamples + numSamples : 0;
+
+    if (path.gain <= 0.0f
+        || path.quietSamples >= static_cast<int> (currentSampleRate * kFdnTailQuietSeconds))
+    {
+        path.fdn.reset();
+        oversampler.reset();
+        path.latencyAlign.reset();
+        path.ringing = false;
+        path.gain = 1.0f;
+    }
+}
+
+void WetStringReverbProcessor::processEarlyLayer()
+{
+    const auto& args = layerJobArgs;
+    if (args.bypassEarly)
+    {
+        juce::FloatVectorOperations::clear (stages.early[0], args.numSamples);
+        juce::FloatVectorOperations::clear (stages.early[1], args.numSamples);
+        return;
+    }
+
+    earlyReflections.process (args.dry, stages.early, args.numSamples, 1.0f, args.preDelaySamples);
+}
+
+void WetStringReverbProcessor::processDvnChannel (int ch, const float* input, float* output,
+                                                  int numSamples, bool halfRate)
+{
+    if (halfRate)
+    {
+        // The attenuated late tail has little energy above fs/4:
+        // decimate, run the sparse filter at half rate, interpolate back
+        float* decimated = dvnHalfRateBuffer.getWritePointer (2 * ch);
+        float* halfOut   = dvnHalfRateBuffer.getWritePointer (2 * ch + 1);
+
+        int numHalf = dvnDecimator[ch].process (input, numSamples, decimated);
+        dvnTailHalfRate[ch].process (decimated, halfOut, numHalf, 1.0f);
+        dvnInterpolator[ch].process (halfOut, output, numSamples);
+    }
+    else
+    {
+        dvnTail[ch].process (input, output, numSamples, 1.0f);
+    }
+}
+
+void WetStringReverbProcessor::processLayerDvnChannel (int ch)
+{
+    processDvnChannel (ch, stages.late[ch], stages.dvn[ch], layerJobArgs.numSamples, layerJobArgs.dvnHalfRate);
+}
+
+void WetStringReverbProcessor::processDvnPipelineJob()
+{
+    const auto& args = dvnPipelineArgs;
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        float* out = dvnPipelineOutput.getWritePointer (ch);
+        if (args.bypass)
+            juce::FloatVectorOperations::clear (out, args.numSamples);
+        else
+            processDvnChannel (ch, dvnPipelineInput.getReadPointer (ch), out, args.numSamples, args.halfRate);
+    }
+}
 
-    lastOversamplingFactor = osFactor;
+void WetStringReverbProcessor::setDvnPipelined (bool shouldPipeline)
+{
+    // Drop whatever is in flight and start the delay line from silence
+    dvnPipelineWorker.wait();
+    dvnPipelineInFlight = 0;
+    dvnPipelineWritePos = 0;
+    dvnPipelineRing.clear();
+    pipelineAlign.reset();
+
+    dvnPipelineActive = shouldPipeline;
+    updateReportedLatency();
 }
 
-void WetStringReverbProcessor::initializeOversampling (int factor)
+void WetStringReverbProcessor::updateReportedLatency()
 {
-    oversamplingManager.prepare (2, factor, currentSampleRate, currentBlockSize);
-    double osRate = oversamplingManager.getOversampledRate (currentSampleRate);
-    int osBlockSize = currentBlockSize * (1 << factor);
-    fdnReverb.prepare (osRate, osBlockSize);
+    pendingLatencySamples.store (oversamplingLatency.load() + (dvnPipelineActive ? currentBlockSize : 0));
+    triggerAsyncUpdate();
+}
 
-    float totalLatency = oversamplingManager.getLatencyInSamples();
-    setLatencySamples (static_cast<int> (totalLatency));
+void WetStringReverbProcessor::reportPendingLatency()
+{
+    const int samples = pendingLatencySamples.exchange (-1);
+    if (samples >= 0 && samples != getLatencySamples())
+        setLatencySamples (samples);
 }
 
 void WetStringReverbProcessor::releaseResources()
 {
+    layerWorkersRunning.store (false);
+    layerWorkers.stop();
+    dvnPipelineWorker.wait();
+    dvnPipelineWorker.stop();
+}
+
+void WetStringReverbProcessor::updateWorkerThreads()
+{
+    // Threads exist only while their switch is on, and the pools leave a
+    // core to the audio thread (none on a single core).  The audio thread
+    // reads layerWorkersRunning, not the pool: a batch launched while the
+    // pool stops is simply run by wait() on the audio thread.
+    const auto options = juce::Thread::RealtimeOptions {}
+                             .withApproximateAudioProcessingTime (currentBlockSize, currentSampleRate);
+    const bool parallel = parallelLayersParam->load() >= 0.5f
+                       && currentBlockSize >= kMinParallelSliceSize;
+    if (parallel)
+        layerWorkers.start (kNumLayerWorkers, options);
+    layerWorkersRunning.store (parallel && layerWorkers.getNumWorkers() > 0);
+    if (! parallel)
+        layerWorkers.stop();
+
+    // The pipelined DVN job always goes through the pool; without a worker
+    // it runs inline when the next slice collects it
+    dvnPipelineWorker.start (dvnPipelineActive ? 1 : 0, options);
+}
+
+void WetStringReverbProcessor::handleAsyncUpdate()
+{
+    updateWorkerThreads();
+
+    // A filter change the audio thread has faded out and let go of: reset
+    // every path for the new filter, then give them back
+    const int filter = oversamplingFilterRequest.load (std::memory_order_acquire);
+    if (filter >= 0)
+    {
+        applyOversamplingFilter (filter);
+        oversamplingFilterRequest.store (-1, std::memory_order_release);
+    }
+
+    reportPendingLatency();
+
+    // Message thread: sequences come from the shared cache, the merged
+    // tap table is built into the ER engine's inactive slot.
+    if (erRegenerationPending.load())
+    {
+        earlyReflections.generatePattern (requestedErLength.load(), requestedErDensity.load());
+        erRegenerationPending.store (false);
+    }
+
+    // FDN paths the audio thread has let go of, then the ones it switched to
+    const uint32_t releases = fdnPathReleaseRequests.exchange (0);
+    const uint32_t requests = fdnPathBuildRequests.exchange (0);
+    for (int factor = 0; factor < kNumOversamplingFactors; ++factor)
+        if ((releases & (1u << factor)) != 0
+            && ! fdnPathReady[static_cast<size_t> (factor)].load (std::memory_order_acquire))
+            fdnPaths[static_cast<size_t> (factor)].reset();
+
+    for (int factor = 0; factor < kNumOversamplingFactors; ++factor)
+        if ((requests & (1u << factor)) != 0
+            && ! fdnPathReady[static_cast<size_t> (factor)].load (std::memory_order_acquire))
+            buildFdnPath (factor);
+}
+
+void WetStringReverbProcessor::requestEarlyPatternIfChanged()
+{
+    if (erRegenerationPending.load() || earlyReflections.isPatternSwapPending())
+        return;
+
+    const float length  = erLengthParam->load();
+    const float density = erDensityParam->load();
+
+    if (length == earlyReflections.getLatestLengthMs()
+        && density == earlyReflections.getLatestDensity())
+        return;
+
+    requestedErLength.store (length);
+    requestedErDensity.store (density);
+    erRegenerationPending.store (true);
+    triggerAsyncUpdate();
 }
 
 void WetStringReverbProcessor::updateParameters()
 {
     // Set smoothing targets from atomic parameter values
     smoothDryWet      .setTargetValue (dryWetParam->load());
-    smoothPreDelay    .setTargetValue (preDelayParam->load());
     smoothEarlyLevel  .setTargetValue (earlyLevelParam->load());
     smoothLateLevel   .setTargetValue (lateLevelParam->load());
     smoothRoomSize    .setTargetValue (roomSizeParam->load());
@@ -159,17 +579,41 @@ void WetStringReverbProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     if (totalNumInputChannels == 1 && totalNumOutputChannels >= 2)
         buffer.copyFrom (1, 0, buffer, 0, 0, numSamples);
 
-    int osFactor = static_cast<int> (oversamplingParam->load());
-    if (osFactor != lastOversamplingFactor)
+    // Worker threads are started and stopped on the message thread
+    const bool parallelLayers = parallelLayersParam->load() >= 0.5f;
+    if (parallelLayers != lastParallelLayers)
     {
-        suspendProcessing (true);
-        initializeOversampling (osFactor);
-        lastOversamplingFactor = osFactor;
-        suspendProcessing (false);
+        lastParallelLayers = parallelLayers;
+        triggerAsyncUpdate();
     }
 
-    // Push new targets — smoothed values advance per-sample below
+    // Every stage is sized for the prepared block size; hosts that send
+    // more are served in prepared-size slices (no allocation, no overrun).
+    // A mono host buffer gets a scratch right channel holding the same dry
+    // signal; its output is discarded.
+    const bool stereo = buffer.getNumChannels() >= 2;
+    for (int start = 0; start < numSamples; start += currentBlockSize)
+    {
+        const int sliceSize = std::min (currentBlockSize, numSamples - start);
+        float* io[2] = { buffer.getWritePointer (0, start),
+                         stereo ? buffer.getWritePointer (1, start) : monoRightBuffer.getWritePointer (0) };
+        if (! stereo)
+            juce::FloatVectorOperations::copy (io[1], io[0], sliceSize);
+
+        processSlice (io, sliceSize);
+    }
+}
+
+/**
+ * One prepared-size slice through the stage pipeline, on raw pointers:
+ * io (dry in) -> ER -> early, io -> pre-delay -> late -> FDN in place,
+ * late -> DVN -> dvn, then the mixer writes io in place.
+ */
+void WetStringReverbProcessor::processSlice (float* const* io, int numSamples)
+{
+    // Push new targets — smoothed values advance per slice below
     updateParameters();
+    requestEarlyPatternIfChanged();
 
     bool bypassEarly = bypassEarlyParam->load() >= 0.5f;
     bool bypassFDN   = bypassFDNParam->load()   >= 0.5f;
@@ -179,52 +623,49 @@ void WetStringReverbProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     bool bAtten = bypassAttenFilterParam->load()  >= 0.5f;
     bool bMod   = bypassModulationParam->load()   >= 0.5f;
 
-    // Dry copy
-    for (int ch = 0; ch < 2 && ch < buffer.getNumChannels(); ++ch)
-        dryBuffer.copyFrom (ch, 0, buffer, ch, 0, numSamples);
-
-    // ---- Pre-Delay (smoothed per-sample) ----
-    for (int i = 0; i < numSamples; ++i)
+    // ---- Early Reflections + Pre-Delay ----
+    // Pre-delay is an integer offset on the ER taps; the FDN feed gets the
+    // same offset from a block-copy delay.  Both crossfade on changes.
     {
-        float preDelaySamples = smoothPreDelay.getNextValue()
-                              * 0.001f * static_cast<float> (currentSampleRate);
+        const int preDelaySamples = static_cast<int> (std::round (
+            preDelayParam->load() * 0.001 * currentSampleRate));
 
-        for (int ch = 0; ch < 2 && ch < buffer.getNumChannels(); ++ch)
-        {
-            preDelayLine[ch].setDelay (preDelaySamples);
-            float in = buffer.getSample (ch, i);
-            preDelayLine[ch].pushSample (0, in);
-            buffer.setSample (ch, i, preDelayLine[ch].popSample (0));
-        }
-    }
+        const float* dryIn[2] = { io[0], io[1] };
+        preDelay.process (dryIn, stages.late, numSamples, preDelaySamples);
 
-    // ---- Early Reflections ----
-    if (bypassEarly)
-    {
-        earlyBuffer.clear (0, 0, numSamples);
-        if (earlyBuffer.getNumChannels() >= 2)
-            earlyBuffer.clear (1, 0, numSamples);
+        layerJobArgs = { { io[0], io[1] }, numSamples, preDelaySamples, bypassEarly };
     }
+
+    // Large slices: ER runs on a worker while this thread runs the FDN
+    const bool parallel = parallelLayersParam->load() >= 0.5f
+                       && layerWorkersRunning.load()
+                       && numSamples >= kMinParallelSliceSize;
+
+    const DSP::RealtimeWorkerPool::Job earlyJob {
+        [] (void* self) { static_cast<WetStringReverbProcessor*> (self)->processEarlyLayer(); }, this };
+
+    if (parallel)
+        layerWorkers.launch (&earlyJob, 1);
     else
-    {
-        for (int ch = 0; ch < 2 && ch < buffer.getNumChannels(); ++ch)
-            earlyReflections[ch].process (buffer.getReadPointer (ch),
-                                           earlyBuffer.getWritePointer (ch),
-                                           numSamples, 1.0f);
-    }
+        earlyJob.run();
 
     // ---- FDN (smoothed parameters fed per sub-block) ----
-    if (bypassFDN)
+    // While a filter change is with the message thread the paths are its
+    // to reset: the FDN stays silent until they come back
+    const int osFilter = static_cast<int> (oversamplingFilterParam->load());
+    const bool filterHandedOver = oversamplingFilterRequest.load (std::memory_order_acquire) >= 0;
+    if (bypassFDN || filterHandedOver)
     {
-        fdnInputBuffer.clear (0, 0, numSamples);
-        if (fdnInputBuffer.getNumChannels() >= 2)
-            fdnInputBuffer.clear (1, 0, numSamples);
+        juce::FloatVectorOperations::clear (stages.late[0], numSamples);
+        juce::FloatVectorOperations::clear (stages.late[1], numSamples);
+
+        // Nothing is audible to fade out: hand a new filter over right away
+        oversamplingFilterChangePending = false;
+        if (! filterHandedOver && osFilter != activeOversamplingFilter)
+            requestOversamplingFilter (osFilter);
     }
     else
     {
-        for (int ch = 0; ch < 2 && ch < buffer.getNumChannels(); ++ch)
-            fdnInputBuffer.copyFrom (ch, 0, buffer, ch, 0, numSamples);
-
         // Advance smoothed values and snapshot for FDN
         float roomSize   = smoothRoomSize   .skip (numSamples);
         float lowRT60    = smoothLowRT60    .skip (numSamples);
@@ -239,78 +680,209 @@ void WetStringReverbProcessor::processBlock (juce::AudioBuffer<float>& buffer,
         float satAsym    = smoothSatAsymmetry.skip (numSamples);
         int   satType    = static_cast<int> (satTypeParam->load());
 
-        fdnReverb.setParameters (roomSize, lowRT60, highRT60, hfDamping, diffusion,
-                                 modDepth, modRate,
-                                 satAmount, satDrive, satType, satTone, satAsym,
-                                 bSat, bTone, bAtten, bMod);
-
-        juce::dsp::AudioBlock<float> fdnBlock (fdnInputBuffer);
-        auto oversampledBlock = oversamplingManager.processSamplesUp (fdnBlock);
-
-        int osNumSamples = static_cast<int> (oversampledBlock.getNumSamples());
-        auto* osL = oversampledBlock.getChannelPointer (0);
-        auto* osR = oversampledBlock.getChannelPointer (1);
-
-        for (int i = 0; i < osNumSamples; ++i)
+        const int antiAlias = static_cast<int> (satAntiAliasParam->load());
+        const int routing = static_cast<int> (fdnRoutingParam->load());
+        const int satOversampling = static_cast<int> (satOversamplingParam->load());
+
+        // Auto oversampling: the loop only needs the oversampled rate while saturating
+        const int osFactor = static_cast<int> (oversamplingParam->load());
+        const bool loopIsLinear = bSat || satAmountParam->load() < 1.0e-3f;
+        const bool autoOversampling = oversamplingAutoParam->load() >= 0.5f;
+
+        // Nonlinear only: the 1x loop oversamples saturation + limiter locally
+        // instead, at least as far as the Saturation Oversampling setting asks
+        const bool nonlinearOnly = oversamplingNonlinearOnlyParam->load() >= 0.5f;
+        const int baseRateSatOversampling = nonlinearOnly ? std::max (osFactor, satOversampling)
+                                                          : satOversampling;
+        selectFdnPath (nonlinearOnly || (autoOversampling && loopIsLinear) ? 0 : osFactor);
+
+        // A new filter type changes the latency: fade every path out, then
+        // have them all restarted from silence with the new filters
+        oversamplingFilterChangePending = osFilter != activeOversamplingFilter;
+
+        bool anyRinging = false;
+        bool allFadedOut = true;
+        for (int factor = 0; factor < kNumOversamplingFactors; ++factor)
         {
-            float outL, outR;
-            fdnReverb.processSample (osL[i], osR[i], outL, outR);
-            osL[i] = outL;
-            osR[i] = outR;
+            if (! fdnPathReady[static_cast<size_t> (factor)].load (std::memory_order_acquire))
+                continue;
+
+            auto& path = *fdnPaths[static_cast<size_t> (factor)];
+            const bool active = factor == activeFdnPath;
+            if (! active && ! path.ringing)
+            {
+                // Idle and not selectable: hand it to the message thread to free
+                if (factor != 0 && (nonlinearOnly || factor != osFactor))
+                {
+                    fdnPathReady[static_cast<size_t> (factor)].store (false, std::memory_order_release);
+                    fdnPathReleaseRequests.fetch_or (1u << factor);
+                    triggerAsyncUpdate();
+                }
+                continue;
+            }
+
+            path.fdn.setParameters (roomSize, lowRT60, highRT60, hfDamping, diffusion,
+                                    modDepth, modRate,
+                                    satAmount, satDrive, satType, satTone, satAsym,
+                                    bSat, bTone, bAtten, bMod);
+            path.fdn.setSaturationAntiAliasing (antiAlias);
+            path.fdn.setSaturationOversampling (factor == 0 ? baseRateSatOversampling : satOversampling);
+            if (path.routing != routing)
+            {
+                path.fdn.setRouting (static_cast<DSP::FDNReverb::Routing> (routing));
+                path.routing = routing;
+            }
+
+            if (active)
+            {
+                processFdnPath (factor, stages.late, numSamples);
+                allFadedOut = allFadedOut && path.gain <= 0.0f;
+                continue;
+            }
+
+            // Ringing out on silence, summed into the tail buffer
+            for (int ch = 0; ch < 2; ++ch)
+                juce::FloatVectorOperations::clear (stages.fdnPath[ch], numSamples);
+            processFdnPath (factor, stages.fdnPath, numSamples);
+            allFadedOut = allFadedOut && (! path.ringing || path.gain <= 0.0f);
+
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                if (anyRinging)
+                    juce::FloatVectorOperations::add (stages.fdnTail[ch], stages.fdnPath[ch], numSamples);
+                else
+                    juce::FloatVectorOperations::copy (stages.fdnTail[ch], stages.fdnPath[ch], numSamples);
+            }
+            anyRinging = true;
         }
 
-        oversamplingManager.processSamplesDown (fdnBlock);
+        if (anyRinging)
+            for (int ch = 0; ch < 2; ++ch)
+                juce::FloatVectorOperations::add (stages.late[ch], stages.fdnTail[ch], numSamples);
+
+        if (oversamplingFilterChangePending && allFadedOut)
+            requestOversamplingFilter (osFilter);
     }
 
+    if (parallel)
+        layerWorkers.wait();
+
+    // Dry and ER take the oversampling latency the FDN paths are padded to
+    float* dryAndEarly[4] = { io[0], io[1], stages.early[0], stages.early[1] };
+    dryAlign.process (dryAndEarly, dryAndEarly, numSamples, oversamplingLatency.load());
+
     // ---- DVN Tail ----
-    if (bypassDVN)
+    const bool pipelined = dvnPipelineActive;
+
+    // Pipelined: the previous slice's job owns the DVN state until it is
+    // collected, so its output goes into the ring before anything else
+    const int ringSize = dvnPipelineRing.getNumSamples();
+    if (pipelined)
     {
-        dvnBuffer.clear (0, 0, numSamples);
-        if (dvnBuffer.getNumChannels() >= 2)
-            dvnBuffer.clear (1, 0, numSamples);
+        dvnPipelineWorker.wait();
+
+        const int first = std::min (dvnPipelineInFlight, ringSize - dvnPipelineWritePos);
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            const float* src = dvnPipelineOutput.getReadPointer (ch);
+            float* ring = dvnPipelineRing.getWritePointer (ch);
+            juce::FloatVectorOperations::copy (ring + dvnPipelineWritePos, src, first);
+            juce::FloatVectorOperations::copy (ring, src + first, dvnPipelineInFlight - first);
+        }
+        dvnPipelineWritePos = (dvnPipelineWritePos + dvnPipelineInFlight) % ringSize;
+        dvnPipelineInFlight = 0;
     }
-    else
+
+    bool dvnHalfRate = false;
+    if (! bypassDVN)
     {
         float decayShape = smoothDecayShape.getCurrentValue();
         float dvnRT60    = smoothLowRT60.getCurrentValue();
-        dvnTail[0].setParameters (decayShape, dvnRT60);
-        dvnTail[1].setParameters (decayShape, dvnRT60);
 
-        for (int ch = 0; ch < 2 && ch < buffer.getNumChannels(); ++ch)
-            dvnTail[ch].process (fdnInputBuffer.getReadPointer (ch),
-                                  dvnBuffer.getWritePointer (ch),
-                                  numSamples, 1.0f);
+        // Switching rates: start the newly active path from silence
+        dvnHalfRate = dvnHalfRateParam->load() >= 0.5f;
+        if (dvnHalfRate != lastDvnHalfRate)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                dvnTail[ch].reset();
+                dvnTailHalfRate[ch].reset();
+                dvnDecimator[ch].reset();
+                dvnInterpolator[ch].reset();
+            }
+            lastDvnHalfRate = dvnHalfRate;
+        }
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            if (dvnHalfRate)
+                dvnTailHalfRate[ch].setParameters (decayShape, dvnRT60);
+            else
+                dvnTail[ch].setParameters (decayShape, dvnRT60);
+        }
     }
 
-    // ---- Mixing (per-sample smoothed dry/wet, early/late levels, width) ----
-    auto* outL = buffer.getWritePointer (0);
-    auto* outR = buffer.getNumChannels() >= 2 ? buffer.getWritePointer (1) : outL;
+    if (pipelined)
+    {
+        // This slice's DVN runs on the worker until the next slice...
+        for (int ch = 0; ch < 2; ++ch)
+            juce::FloatVectorOperations::copy (dvnPipelineInput.getWritePointer (ch), stages.late[ch], numSamples);
+        dvnPipelineArgs = { numSamples, bypassDVN, dvnHalfRate };
+        dvnPipelineInFlight = numSamples;
+
+        const DSP::RealtimeWorkerPool::Job job {
+            [] (void* self) { static_cast<WetStringReverbProcessor*> (self)->processDvnPipelineJob(); }, this };
+        dvnPipelineWorker.launch (&job, 1);
+
+        // ...while this one mixes everything one prepared block late, where
+        // the ring already holds finished DVN (slices never exceed a block)
+        float* aligned[6] = { io[0], io[1], stages.early[0], stages.early[1], stages.late[0], stages.late[1] };
+        pipelineAlign.process (aligned, aligned, numSamples, currentBlockSize);
+
+        const int readPos = (dvnPipelineWritePos - currentBlockSize + ringSize) % ringSize;
+        const int first = std::min (numSamples, ringSize - readPos);
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            const float* ring = dvnPipelineRing.getReadPointer (ch);
+            juce::FloatVectorOperations::copy (stages.dvn[ch], ring + readPos, first);
+            juce::FloatVectorOperations::copy (stages.dvn[ch] + first, ring, numSamples - first);
+        }
+    }
+    else if (bypassDVN)
+    {
+        juce::FloatVectorOperations::clear (stages.dvn[0], numSamples);
+        juce::FloatVectorOperations::clear (stages.dvn[1], numSamples);
+    }
+    else
+    {
+        // The two channels are independent: one job each
+        layerJobArgs.dvnHalfRate = dvnHalfRate;
+        const DSP::RealtimeWorkerPool::Job dvnJobs[2] = {
+            { [] (void* self) { static_cast<WetStringReverbProcessor*> (self)->processLayerDvnChannel (0); }, this },
+            { [] (void* self) { static_cast<WetStringReverbProcessor*> (self)->processLayerDvnChannel (1); }, this }
+        };
+
+        if (parallel)
+        {
+            layerWorkers.launch (dvnJobs, 2);
+            layerWorkers.wait();
+        }
+        else
+        {
+            dvnJobs[0].run();
+            dvnJobs[1].run();
+        }
+    }
 
-    for (int i = 0; i < numSamples; ++i)
+    // ---- Mixing (gains ramp across the block to the smoothed values) ----
     {
-        float dw = smoothDryWet     .getNextValue();
-        float el = smoothEarlyLevel .getNextValue();
-        float ll = smoothLateLevel  .getNextValue();
-        float sw = smoothStereoWidth.getNextValue();
-
-        reverbMixer.setParameters (dw, el, ll, sw);
-
-        float mixL, mixR;
-        reverbMixer.process (
-            dryBuffer.getReadPointer (0)[i],
-            dryBuffer.getNumChannels() >= 2 ? dryBuffer.getReadPointer (1)[i]
-                                            : dryBuffer.getReadPointer (0)[i],
-            earlyBuffer.getReadPointer (0)[i],
-            earlyBuffer.getReadPointer (1)[i],
-            fdnInputBuffer.getReadPointer (0)[i],
-            fdnInputBuffer.getNumChannels() >= 2 ? fdnInputBuffer.getReadPointer (1)[i]
-                                                 : fdnInputBuffer.getReadPointer (0)[i],
-            dvnBuffer.getReadPointer (0)[i],
-            dvnBuffer.getReadPointer (1)[i],
-            mixL, mixR);
-        outL[i] = mixL;
-        if (outR != outL)
-            outR[i] = mixR;
+        const auto target = DSP::ReverbMixer::makeGains (smoothDryWet     .skip (numSamples),
+                                                         smoothEarlyLevel .skip (numSamples),
+                                                         smoothLateLevel  .skip (numSamples),
+                                                         smoothStereoWidth.skip (numSamples));
+
+        reverbMixer.setClipAntiAliasing (outputClipAdaaParam->load() >= 0.5f);
+        reverbMixer.processBlock (io, stages.early, stages.late, stages.dvn, numSamples, target);
     }
 }
 
@@ -4,16 +4,21 @@
 #include <juce_dsp/juce_dsp.h>
 #include "Parameters.h"
 #include "DSP/EarlyReflections.h"
+#include "DSP/PreDelay.h"
 #include "DSP/FDNReverb.h"
 #include "DSP/DarkVelvetNoise.h"
+#include "DSP/HalfbandResampler.h"
 #include "DSP/OversamplingManager.h"
 #include "DSP/ReverbMixer.h"
+#include "DSP/RealtimeWorkerPool.h"
+#include <array>
 
-class WetStringReverbProcessor : public juce::AudioProcessor
+class WetStringReverbProcessor : public juce::AudioProcessor,
+                                 private juce::AsyncUpdater
 {
 public:
     WetStringReverbProcessor();
-    ~WetStringReverbProcessor() override = default;
+    ~WetStringReverbProcessor() override;
 
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
@@ -40,6 +45,16 @@ public:
 
     juce::AudioProcessorValueTreeState apvts;
 
+    // Runs pending message-thread work (ER patterns, FDN path builds,
+    // latency reports) now
+    using juce::AsyncUpdater::handleUpdateNowIfNeeded;
+
+    // FDN paths currently allocated, the 1x path included
+    int getNumBuiltFdnPaths() const;
+
+    // Helper threads currently running (parallel layers, pipelined DVN)
+    int getNumWorkerThreads() const { return layerWorkers.getNumWorkers() + dvnPipelineWorker.getNumWorkers(); }
+
 private:
     // Parameter atomic pointers
     std::atomic<float>* dryWetParam       = nullptr;
@@ -49,22 +64,35 @@ private:
     std::atomic<float>* roomSizeParam     = nullptr;
     std::atomic<float>* stereoWidthParam  = nullptr;
     std::atomic<float>* oversamplingParam = nullptr;
+    std::atomic<float>* oversamplingFilterParam = nullptr;
 
     std::atomic<float>* lowRT60Param      = nullptr;
     std::atomic<float>* highRT60Param     = nullptr;
     std::atomic<float>* hfDampingParam    = nullptr;
     std::atomic<float>* diffusionParam    = nullptr;
     std::atomic<float>* decayShapeParam   = nullptr;
+    std::atomic<float>* fdnRoutingParam   = nullptr;
+    std::atomic<float>* erLengthParam     = nullptr;
+    std::atomic<float>* erDensityParam    = nullptr;
 
     std::atomic<float>* satAmountParam    = nullptr;
     std::atomic<float>* satDriveParam     = nullptr;
     std::atomic<float>* satTypeParam      = nullptr;
     std::atomic<float>* satToneParam      = nullptr;
     std::atomic<float>* satAsymmetryParam = nullptr;
+    std::atomic<float>* satAntiAliasParam = nullptr;
+    std::atomic<float>* satOversamplingParam = nullptr;
 
     std::atomic<float>* modDepthParam     = nullptr;
     std::atomic<float>* modRateParam      = nullptr;
 
+    std::atomic<float>* dvnHalfRateParam  = nullptr;
+    std::atomic<float>* oversamplingAutoParam = nullptr;
+    std::atomic<float>* oversamplingNonlinearOnlyParam = nullptr;
+    std::atomic<float>* outputClipAdaaParam = nullptr;
+    std::atomic<float>* parallelLayersParam = nullptr;
+    std::atomic<float>* dvnPipelinedParam   = nullptr;
+
     // Debug bypass switches
     std::atomic<float>* bypassEarlyParam      = nullptr;
     std::atomic<float>* bypassFDNParam        = nullptr;
@@ -78,7 +106,6 @@ private:
     static constexpr double kSmoothTimeSeconds = 0.05;
 
     juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> smoothDryWet;
-    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> smoothPreDelay;
     juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> smoothEarlyLevel;
     juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> smoothLateLevel;
     juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> smoothRoomSize;
@@ -99,28 +126,178 @@ private:
     juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> smoothModRate;
 
     // DSP
-    DSP::EarlyReflections earlyReflections[2];
-    DSP::FDNReverb fdnReverb;
+    DSP::EarlyReflections earlyReflections;
+    DSP::PreDelay preDelay;
     DSP::DarkVelvetNoise dvnTail[2];
-    DSP::OversamplingManager oversamplingManager;
+    DSP::DarkVelvetNoise dvnTailHalfRate[2];
+    DSP::HalfbandDecimator dvnDecimator[2];
+    DSP::HalfbandInterpolator dvnInterpolator[2];
+
+    // One FDN path per oversampling factor.  prepareToPlay() builds the
+    // 1x path and the selected factor (none in nonlinear-only mode); any
+    // other factor is requested by the audio thread, built in
+    // handleAsyncUpdate() on the message thread and published through
+    // fdnPathReady, the current path running until it is.  A switch to an
+    // unbuilt factor so waits for the message thread (usually a UI frame,
+    // longer behind a modal dialog); offline renders, which may block it
+    // throughout, build the path on the audio thread instead.  Paths that
+    // have rung out and are no longer selectable are unpublished by the
+    // audio thread and freed on the message thread the same way.  Every
+    // path is
+    // delayed up to the largest oversampler latency (from
+    // fdnPathLatencies, so unbuilt paths count too), and dry and ER by
+    // that whole latency (dryAlign), so the reported latency is fixed
+    // for the session and the layers stay aligned.  "Off" therefore reports
+    // the 16x latency of the chosen filter too: a few samples for the IIR
+    // filters, tens of samples for the linear-phase FIR.  On a switch the
+    // outgoing path rings out on silence and is summed in until its tail
+    // has decayed (exact for a linear loop); tails that outlast
+    // kFdnTailMaxSeconds are faded out.  Auto oversampling selects the 1x
+    // path while the loop is linear (no saturation).  Each path holds an
+    // oversampler per filter type.  Changing the type changes the reported
+    // latency, so it fades every path out (cutting the tail) and hands them
+    // to the message thread, which resets them for the new filter and
+    // reports the latency (oversamplingFilterRequest).
+    static constexpr int kNumOversamplingFactors = 5;      // Off, 2x, 4x, 8x, 16x
+    static constexpr double kFdnTailQuietSeconds = 0.1;
+    static constexpr double kFdnTailMaxSeconds = 4.0;
+    static constexpr double kFdnTailFadeSeconds = 0.05;
+    static constexpr float kFdnTailSilence = 1.0e-5f;
+
+    struct FdnPath
+    {
+        std::array<DSP::OversamplingManager, DSP::OversamplingManager::kNumFilters> oversamplers;
+        DSP::FDNReverb fdn;
+        DSP::PreDelay latencyAlign;     // pads this path to the common latency
+        bool ringing = false;
+        int quietSamples = 0;
+        int ringingSamples = 0;
+        float gain = 1.0f;
+        int routing = -1;               // FDNReverb::Routing last applied, -1 = none
+    };
+
+    std::array<std::unique_ptr<FdnPath>, kNumOversamplingFactors> fdnPaths;   // index = factor
+    std::array<std::atomic<bool>, kNumOversamplingFactors> fdnPathReady {};
+    std::atomic<uint32_t> fdnPathBuildRequests { 0 };                         // bit per factor
+    std::atomic<uint32_t> fdnPathReleaseRequests { 0 };
+    std::array<std::array<float, DSP::OversamplingManager::kNumFilters>,
+               kNumOversamplingFactors> fdnPathLatencies {};
+    std::array<int, kNumOversamplingFactors> fdnPathAlignDelays {};
+    int maxOversamplingLatency = 0;     // longest of fdnPathLatencies, rounded
+    int activeFdnPath = 0;
+    int activeOversamplingFilter = 1;
+    bool oversamplingFilterChangePending = false;
+    std::atomic<int> oversamplingLatency { 0 };
+    DSP::PreDelay dryAlign;             // dry L/R, early L/R
+
+    // Filter change handed to the message thread once every path has faded
+    // out (-1 = none); the audio thread leaves the paths alone until then
+    std::atomic<int> oversamplingFilterRequest { -1 };
+
+    // setLatencySamples() calls back into the host, so the audio thread only
+    // posts the new figure here; handleAsyncUpdate() reports it (-1 = none)
+    std::atomic<int> pendingLatencySamples { -1 };
     DSP::ReverbMixer reverbMixer;
 
-    // Pre-delay
-    juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear> preDelayLine[2];
-    static constexpr int MAX_PRE_DELAY_SAMPLES = 4800;
+    // Pre-delay is folded into the ER tap offsets (crossfaded on change)
+    static constexpr double kMaxPreDelaySeconds = 0.1;
+
+    // ER pattern regeneration: requested on the audio thread, built in
+    // handleAsyncUpdate() on the message thread, swapped in by the ER engine
+    std::atomic<float> requestedErLength  { 30.0f };
+    std::atomic<float> requestedErDensity { 2000.0f };
+    std::atomic<bool>  erRegenerationPending { false };
 
-    // Internal buffers
-    juce::AudioBuffer<float> dryBuffer;
+    // Internal buffers (the host buffer itself carries the dry signal)
     juce::AudioBuffer<float> earlyBuffer;
-    juce::AudioBuffer<float> fdnInputBuffer;
+    juce::AudioBuffer<float> fdnInputBuffer;      // pre-delayed feed, FDN in place
     juce::AudioBuffer<float> dvnBuffer;
+    juce::AudioBuffer<float> dvnHalfRateBuffer;   // per channel: [decimated input, DVN output]
+    juce::AudioBuffer<float> fdnTailBuffer;       // sum of ringing paths
+    juce::AudioBuffer<float> fdnPathBuffer;       // one ringing path
+    juce::AudioBuffer<float> monoRightBuffer;     // right channel for mono hosts
+
+    // Channel pointers into the buffers above, resolved once in
+    // prepareToPlay (they are not resized afterwards)
+    struct StagePointers
+    {
+        float* early[2]   {};
+        float* late[2]    {};
+        float* dvn[2]     {};
+        float* fdnTail[2] {};
+        float* fdnPath[2] {};
+    };
+    StagePointers stages;
+
+    // Parallel layers: ER alongside the FDN, then the two DVN channels.
+    // At most two layer jobs are open and this thread takes one, so a
+    // single worker covers them; the pool drops it on a single core.  It
+    // runs only while the switch is on (updateWorkerThreads).
+    static constexpr int kNumLayerWorkers = 1;
+    static constexpr int kMinParallelSliceSize = 256;
+    DSP::RealtimeWorkerPool layerWorkers;
+    std::atomic<bool> layerWorkersRunning { false };
+    bool lastParallelLayers = false;              // audio thread
+
+    // Arguments of the current slice's layer jobs
+    struct LayerJobArgs
+    {
+        const float* dry[2] {};
+        int numSamples = 0;
+        int preDelaySamples = 0;
+        bool bypassEarly = false;
+        bool dvnHalfRate = false;
+    };
+    LayerJobArgs layerJobArgs;
+
+    // Pipelined DVN: slice k's DVN runs on its own worker while slice k+1
+    // is processed.  Dry, ER and late are delayed by one prepared block
+    // (pipelineAlign) and the DVN output is read back from a ring at the
+    // same delay, so every slice mixes DVN that has already finished.
+    // The batch stays open across slices, hence a pool of its own, with a
+    // worker only while the mode is on (updateWorkerThreads).  The mode is
+    // latched by prepareToPlay(): switching live would jump every layer by
+    // a block and drop the job in flight, so the switch waits for the host
+    // to prepare again.
+    DSP::RealtimeWorkerPool dvnPipelineWorker;
+    DSP::PreDelay pipelineAlign;                  // dry L/R, early L/R, late L/R
+    juce::AudioBuffer<float> dvnPipelineInput;    // late feed of the job in flight
+    juce::AudioBuffer<float> dvnPipelineOutput;   // its DVN output
+    juce::AudioBuffer<float> dvnPipelineRing;     // 2 prepared blocks of DVN output
+    int dvnPipelineWritePos = 0;
+    int dvnPipelineInFlight = 0;                  // samples of the job in flight
+    bool dvnPipelineActive = false;               // latched in prepareToPlay()
+
+    struct DvnPipelineArgs
+    {
+        int numSamples = 0;
+        bool bypass = false;
+        bool halfRate = false;
+    };
+    DvnPipelineArgs dvnPipelineArgs;
 
     double currentSampleRate = 44100.0;
     int currentBlockSize = 512;
-    int lastOversamplingFactor = -1;
+    bool lastDvnHalfRate = false;
 
+    void handleAsyncUpdate() override;
+    void requestEarlyPatternIfChanged();
+    void processSlice (float* const* io, int numSamples);
+    void processEarlyLayer();
+    void processLayerDvnChannel (int channel);
+    void processDvnChannel (int channel, const float* input, float* output, int numSamples, bool halfRate);
+    void processDvnPipelineJob();
+    void setDvnPipelined (bool shouldPipeline);
+    void updateReportedLatency();
+    void reportPendingLatency();
+    void updateWorkerThreads();
     void updateParameters();
-    void initializeOversampling (int factor);
+    void prepareFdnPaths();
+    void buildFdnPath (int factor);
+    void applyOversamplingFilter (int filter);
+    void requestOversamplingFilter (int filter);
+    void selectFdnPath (int factor);
+    void processFdnPath (int factor, float* const* io, int numSamples);
     void initAllSmoothedValues (double sampleRate);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WetStringReverbProcessor)
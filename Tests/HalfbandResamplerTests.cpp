@@ -0,0 +1,174 @@
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_dsp/juce_dsp.h>
+#include "../Source/DSP/HalfbandResampler.h"
+#include "../Source/DSP/DarkVelvetNoise.h"
+#include <cmath>
+#include <vector>
+
+//==============================================================================
+class HalfbandResamplerTests : public juce::UnitTest
+{
+public:
+    HalfbandResamplerTests() : juce::UnitTest ("Halfband Resampler Tests") {}
+
+    void runTest() override
+    {
+        beginTest ("Decimate + interpolate passes low frequencies with fixed delay");
+        {
+            DSP::HalfbandDecimator dec;
+            DSP::HalfbandInterpolator itp;
+            dec.reset();
+            itp.reset();
+
+            const int total = 9600;
+            const int delay = 2 * DSP::HalfbandCoefficients::LATENCY;
+            std::vector<float> input ((size_t) total), output ((size_t) total);
+            for (int i = 0; i < total; ++i)
+                input[(size_t) i] = std::sin (2.0f * juce::MathConstants<float>::pi * 2000.0f
+                                              * static_cast<float> (i) / 48000.0f);
+
+            // Odd block sizes: both stages must stay in phase
+            std::vector<float> half (64);
+            const int blockSizes[] = { 17, 64, 1, 33, 50 };
+            int pos = 0, b = 0;
+            while (pos < total)
+            {
+                const int n = std::min (blockSizes[b++ % 5], total - pos);
+                dec.process (input.data() + pos, n, half.data());
+                itp.process (half.data(), output.data() + pos, n);
+                pos += n;
+            }
+
+            float maxError = 0.0f;
+            for (int i = 1000; i < total; ++i)
+                maxError = std::max (maxError, std::abs (output[(size_t) i] - input[(size_t) (i - delay)]));
+
+            expect (maxError < 1.0e-2f, "Round trip error " + juce::String (maxError));
+        }
+
+        beginTest ("Decimator rejects content above the new Nyquist");
+        {
+            DSP::HalfbandDecimator dec;
+            dec.reset();
+
+            const int total = 4800;
+            std::vector<float> input ((size_t) total), half ((size_t) total / 2 + 1);
+            for (int i = 0; i < total; ++i)
+                input[(size_t) i] = std::sin (2.0f * juce::MathConstants<float>::pi * 18000.0f
+                                              * static_cast<float> (i) / 48000.0f);
+
+            const int m = dec.process (input.data(), total, half.data());
+            expectEquals (m, total / 2);
+
+            float peak = 0.0f;
+            for (int i = 100; i < m; ++i)
+                peak = std::max (peak, std::abs (half[(size_t) i]));
+
+            expect (peak < 1.0e-3f, "18 kHz should be rejected, peak " + juce::String (peak));
+        }
+
+        beginTest ("Half-rate DVN spectrum matches the full-rate path below 8 kHz");
+        {
+            const double sr = 48000.0;
+            const int blockSize = 256;
+            const int total = blockSize * 560;
+
+            DSP::DarkVelvetNoise full, halfRate;
+            full.prepare (sr, blockSize, 0xABCD1234u);
+            halfRate.prepare (sr * 0.5, blockSize / 2 + 1, 0xABCD1234u);
+            do
+            {
+                full.setParameters (40.0f, 2.5f);
+                halfRate.setParameters (40.0f, 2.5f);
+            }
+            while (full.isEnvelopeUpdatePending() || halfRate.isEnvelopeUpdatePending());
+
+            DSP::HalfbandDecimator dec;
+            DSP::HalfbandInterpolator itp;
+            dec.reset();
+            itp.reset();
+
+            std::vector<float> in ((size_t) blockSize), decimated ((size_t) blockSize), halfOut ((size_t) blockSize);
+            std::vector<float> a ((size_t) total), b ((size_t) total);
+            uint32_t rng = 7u;
+            for (int s = 0; s < total; s += blockSize)
+            {
+                for (auto& x : in)
+                {
+                    rng = rng * 1664525u + 1013904223u;
+                    x = static_cast<float> (rng) / 4294967295.0f - 0.5f;
+                }
+
+                full.process (in.data(), a.data() + s, blockSize, 1.0f);
+
+                const int m = dec.process (in.data(), blockSize, decimated.data());
+                halfRate.process (decimated.data(), halfOut.data(), m, 1.0f);
+                itp.process (halfOut.data(), b.data() + s, blockSize);
+            }
+
+            auto fullBands = octaveBandEnergies (a, sr);
+            auto halfBands = octaveBandEnergies (b, sr);
+
+            // Bands: 125, 250, ... 16k (lower edges)
+            for (size_t band = 0; band + 1 < fullBands.size(); ++band)
+            {
+                const double diffDb = 10.0 * std::log10 (halfBands[band] / fullBands[band]);
+                const double lowerEdge = 125.0 * std::pow (2.0, (double) band);
+
+                if (lowerEdge < 4000.0)
+                    expect (std::abs (diffDb) < 1.5,
+                        "Band " + juce::String (lowerEdge) + " Hz differs by " + juce::String (diffDb) + " dB");
+                else if (lowerEdge < 8000.0)
+                    expect (std::abs (diffDb) < 3.0,
+                        "Band " + juce::String (lowerEdge) + " Hz differs by " + juce::String (diffDb) + " dB");
+            }
+
+            const double topDiffDb = 10.0 * std::log10 (halfBands.back() / fullBands.back());
+            expect (topDiffDb < -40.0, "Half-rate path should be band-limited, top band " + juce::String (topDiffDb) + " dB");
+        }
+    }
+
+private:
+    /** Averaged Hann-windowed power in octave bands from 125 Hz up to Nyquist. */
+    static std::vector<double> octaveBandEnergies (const std::vector<float>& signal, double sampleRate)
+    {
+        constexpr int order = 11;
+        constexpr int N = 1 << order;
+        juce::dsp::FFT fft (order);
+
+        std::vector<double> power (N / 2, 0.0);
+        std::vector<float> buffer (2 * N);
+
+        for (size_t start = 48000; start + N <= signal.size(); start += N)
+        {
+            for (int i = 0; i < N; ++i)
+            {
+                const float w = 0.5f - 0.5f * std::cos (2.0f * juce::MathConstants<float>::pi
+                                                        * static_cast<float> (i) / static_cast<float> (N));
+                buffer[(size_t) i] = signal[start + (size_t) i] * w;
+            }
+            std::fill (buffer.begin() + N, buffer.end(), 0.0f);
+            fft.performRealOnlyForwardTransform (buffer.data());
+
+            for (int k = 0; k < N / 2; ++k)
+                power[(size_t) k] += buffer[(size_t) (2 * k)] * buffer[(size_t) (2 * k)]
+                                   + buffer[(size_t) (2 * k + 1)] * buffer[(size_t) (2 * k + 1)];
+        }
+
+        std::vector<double> bands;
+        for (double lo = 125.0; lo < sampleRate * 0.5; lo *= 2.0)
+        {
+            double e = 0.0;
+            for (int k = 0; k < N / 2; ++k)
+            {
+                const double f = k * sampleRate / N;
+                if (f >= lo && f < lo * 2.0)
+                    e += power[(size_t) k];
+            }
+            bands.push_back (e + 1.0e-30);
+        }
+        return bands;
+    }
+};
+
+static HalfbandResamplerTests halfbandResamplerTests;
@@ -27,6 +27,16 @@ public:
             processWithOversamplingFactor (2, 44100.0, 512);
         }
 
+        beginTest ("OS 8x does not crash");
+        {
+            processWithOversamplingFactor (3, 44100.0, 512);
+        }
+
+        beginTest ("OS 16x does not crash");
+        {
+            processWithOversamplingFactor (4, 44100.0, 512);
+        }
+
         beginTest ("OS latency is reported correctly");
         {
             DSP::OversamplingManager osm;
@@ -42,6 +52,10 @@ public:
             osm.prepare (2, 2, 44100.0, 512);
             expect (osm.getLatencyInSamples() > 0.0f,
                 "4x should have non-zero latency");
+
+            osm.prepare (2, 4, 44100.0, 512);
+            expect (osm.getLatencyInSamples() > 0.0f,
+                "16x should have non-zero latency");
         }
 
         beginTest ("OS rate calculation is correct");
@@ -62,11 +76,391 @@ public:
             expectWithinAbsoluteError (
                 static_cast<float> (osm.getOversampledRate (44100.0)),
                 176400.0f, 0.1f, "4x: rate should be 176400");
+
+            osm.prepare (2, 3, 44100.0, 512);
+            expectWithinAbsoluteError (
+                static_cast<float> (osm.getOversampledRate (44100.0)),
+                352800.0f, 0.1f, "8x: rate should be 352800");
+
+            osm.prepare (2, 4, 44100.0, 512);
+            expectWithinAbsoluteError (
+                static_cast<float> (osm.getOversampledRate (44100.0)),
+                705600.0f, 0.1f, "16x: rate should be 705600");
+        }
+
+        beginTest ("Filter options: latency and CPU");
+        {
+            using Filter = DSP::OversamplingManager::Filter;
+            const std::array<Filter, 3> filters = { Filter::LowLatencyIIR, Filter::IIR, Filter::LinearPhaseFIR };
+            const char* filterNames[] = { "Low Latency IIR", "IIR", "Linear Phase FIR" };
+
+            constexpr int blockSize = 512;
+            constexpr int numBlocks = 400;
+            juce::AudioBuffer<float> buffer (2, blockSize);
+            uint32_t rng = 3u;
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    rng = rng * 1664525u + 1013904223u;
+                    buffer.getWritePointer (ch)[i] = (float) rng / 4294967295.0f - 0.5f;
+                }
+
+            for (int factor = 1; factor <= 2; ++factor)
+            {
+                std::array<float, 3> latency {};
+                for (size_t f = 0; f < filters.size(); ++f)
+                {
+                    DSP::OversamplingManager osm;
+                    osm.prepare (2, factor, 48000.0, blockSize, filters[f]);
+                    latency[f] = osm.getLatencyInSamples();
+
+                    // Up + down only: the cost the filter adds around the FDN
+                    const double start = juce::Time::getMillisecondCounterHiRes();
+                    for (int b = 0; b < numBlocks; ++b)
+                    {
+                        juce::dsp::AudioBlock<float> block (buffer);
+                        osm.processSamplesUp (block);
+                        osm.processSamplesDown (block);
+                    }
+                    const double elapsedMs = juce::Time::getMillisecondCounterHiRes() - start;
+                    const double realTimeMs = 1000.0 * numBlocks * blockSize / 48000.0;
+
+                    logMessage (juce::String (1 << factor) + "x " + filterNames[f]
+                                + ": latency " + juce::String (latency[f], 2) + " samples, CPU "
+                                + juce::String (100.0 * elapsedMs / realTimeMs, 3) + "% of real time");
+                }
+
+                expect (latency[0] <= latency[1], "Low-latency IIR should not add latency over IIR");
+                expect (latency[1] < latency[2], "Linear-phase FIR should have the longest latency");
+            }
+        }
+
+        beginTest ("Filter change updates the reported latency without re-preparing");
+        {
+            WetStringReverbProcessor processor;
+            processor.prepareToPlay (48000.0, 256);
+            const int iirLatency = processor.getLatencySamples();
+
+            auto* param = processor.apvts.getParameter (Parameters::OVERSAMPLING_FILTER);
+            param->setValueNotifyingHost (param->convertTo0to1 (2.0f));
+
+            juce::AudioBuffer<float> buffer (2, 256);
+            juce::MidiBuffer midi;
+            bool finite = true;
+            for (int b = 0; b < 40; ++b)
+            {
+                buffer.clear();
+                buffer.getWritePointer (0)[0] = 0.5f;
+                buffer.getWritePointer (1)[0] = 0.5f;
+                processor.processBlock (buffer, midi);
+
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = 0; i < 256; ++i)
+                        finite = finite && std::isfinite (buffer.getSample (ch, i));
+            }
+
+            expect (finite, "Output should stay finite across the filter change");
+            expectEquals (processor.getLatencySamples(), iirLatency,
+                          "The audio thread must not report latency itself");
+
+            processor.handleUpdateNowIfNeeded();    // message thread
+            expect (processor.getLatencySamples() > iirLatency,
+                "FIR latency " + juce::String (processor.getLatencySamples())
+                + " should exceed IIR latency " + juce::String (iirLatency));
+        }
+
+        beginTest ("Filter change restarts the FDN once the message thread has run");
+        {
+            for (bool offline : { false, true })
+            {
+                WetStringReverbProcessor processor;
+                processor.setNonRealtime (offline);
+                auto* dryWet = processor.apvts.getParameter (Parameters::DRY_WET);
+                dryWet->setValueNotifyingHost (dryWet->convertTo0to1 (100.0f));
+                processor.apvts.getParameter (Parameters::BYPASS_EARLY)->setValueNotifyingHost (1.0f);
+                processor.apvts.getParameter (Parameters::BYPASS_DVN)->setValueNotifyingHost (1.0f);
+                processor.prepareToPlay (48000.0, 256);
+
+                auto* param = processor.apvts.getParameter (Parameters::OVERSAMPLING_FILTER);
+                param->setValueNotifyingHost (param->convertTo0to1 (2.0f));
+
+                // FDN only: fade out (50 ms), then excite it again without
+                // ever pumping the message thread
+                juce::AudioBuffer<float> buffer (2, 256);
+                juce::MidiBuffer midi;
+                float late = 0.0f;
+                for (int b = 0; b < 40; ++b)
+                {
+                    buffer.clear();
+                    for (int ch = 0; ch < 2; ++ch)
+                        buffer.setSample (ch, 0, 0.5f);
+                    processor.processBlock (buffer, midi);
+                    if (b >= 30)
+                        for (int i = 0; i < 256; ++i)
+                            late = std::max (late, std::abs (buffer.getSample (0, i)));
+                }
+
+                if (offline)
+                {
+                    expect (late > 1.0e-4f, "An offline render must not wait for the message thread");
+                    continue;
+                }
+
+                expect (late < 1.0e-6f, "The FDN stays silent while the message thread owns the paths");
+
+                processor.handleUpdateNowIfNeeded();
+                late = 0.0f;
+                for (int b = 0; b < 10; ++b)
+                {
+                    buffer.clear();
+                    for (int ch = 0; ch < 2; ++ch)
+                        buffer.setSample (ch, 0, 0.5f);
+                    processor.processBlock (buffer, midi);
+                    for (int i = 0; i < 256; ++i)
+                        late = std::max (late, std::abs (buffer.getSample (0, i)));
+                }
+                expect (late > 1.0e-4f, "The FDN comes back with the new filter");
+            }
+        }
+
+        beginTest ("Filter change takes effect while the FDN is bypassed");
+        {
+            WetStringReverbProcessor processor;
+            processor.apvts.getParameter (Parameters::BYPASS_FDN)->setValueNotifyingHost (1.0f);
+            processor.prepareToPlay (48000.0, 256);
+            const int iirLatency = processor.getLatencySamples();
+
+            auto* param = processor.apvts.getParameter (Parameters::OVERSAMPLING_FILTER);
+            param->setValueNotifyingHost (param->convertTo0to1 (2.0f));
+
+            juce::AudioBuffer<float> buffer (2, 256);
+            juce::MidiBuffer midi;
+            buffer.clear();
+            processor.processBlock (buffer, midi);
+            processor.handleUpdateNowIfNeeded();
+
+            expect (processor.getLatencySamples() > iirLatency,
+                "The FIR latency should be reported after the next block, got "
+                + juce::String (processor.getLatencySamples()));
+        }
+
+        beginTest ("Oversampled FDN paths are built on demand off the audio thread");
+        {
+            WetStringReverbProcessor processor;
+            processor.prepareToPlay (96000.0, 256);
+            expectEquals (processor.getNumBuiltFdnPaths(), 2, "1x and the default 2x path only");
+            const int latency = processor.getLatencySamples();
+
+            auto* param = processor.apvts.getParameter (Parameters::OVERSAMPLING);
+            param->setValueNotifyingHost (param->convertTo0to1 (4.0f));
+
+            juce::AudioBuffer<float> buffer (2, 256);
+            juce::MidiBuffer midi;
+            buffer.clear();
+            buffer.getWritePointer (0)[0] = 0.5f;
+            processor.processBlock (buffer, midi);
+            expectEquals (processor.getNumBuiltFdnPaths(), 2, "The audio thread must not build the 16x path");
+
+            processor.handleUpdateNowIfNeeded();
+            expectEquals (processor.getNumBuiltFdnPaths(), 3);
+
+            bool finite = true;
+            for (int b = 0; b < 8; ++b)
+            {
+                buffer.clear();
+                processor.processBlock (buffer, midi);
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = 0; i < 256; ++i)
+                        finite = finite && std::isfinite (buffer.getSample (ch, i));
+            }
+
+            expect (finite, "Output should stay finite across the switch");
+            expectEquals (processor.getLatencySamples(), latency,
+                "Unbuilt paths are already counted in the reported latency");
+        }
+
+        beginTest ("Offline renders build a requested FDN path in place");
+        {
+            WetStringReverbProcessor processor;
+            processor.setNonRealtime (true);
+            processor.prepareToPlay (96000.0, 256);
+            expectEquals (processor.getNumBuiltFdnPaths(), 2);
+
+            auto* param = processor.apvts.getParameter (Parameters::OVERSAMPLING);
+            param->setValueNotifyingHost (param->convertTo0to1 (4.0f));
+
+            juce::AudioBuffer<float> buffer (2, 256);
+            juce::MidiBuffer midi;
+            buffer.clear();
+            processor.processBlock (buffer, midi);
+            expectEquals (processor.getNumBuiltFdnPaths(), 3,
+                          "A blocked message thread must not hold up the switch");
+        }
+
+        beginTest ("Nonlinear-only mode keeps only the 1x FDN path allocated");
+        {
+            WetStringReverbProcessor processor;
+            auto setParam = [&processor] (const char* id, float value)
+            {
+                auto* param = processor.apvts.getParameter (id);
+                param->setValueNotifyingHost (param->convertTo0to1 (value));
+            };
+
+            setParam (Parameters::OVERSAMPLING, 4.0f);
+            setParam (Parameters::OVERSAMPLING_NONLINEAR_ONLY, 1.0f);
+            processor.prepareToPlay (96000.0, 256);
+            expectEquals (processor.getNumBuiltFdnPaths(), 1);
+
+            // Leaving the mode builds 16x; coming back frees it once it has rung out
+            juce::AudioBuffer<float> buffer (2, 256);
+            juce::MidiBuffer midi;
+            auto run = [&] (int numBlocks)
+            {
+                for (int b = 0; b < numBlocks; ++b)
+                {
+                    buffer.clear();
+                    processor.processBlock (buffer, midi);
+                    processor.handleUpdateNowIfNeeded();
+                }
+            };
+
+            setParam (Parameters::OVERSAMPLING_NONLINEAR_ONLY, 0.0f);
+            run (2);
+            expectEquals (processor.getNumBuiltFdnPaths(), 2);
+
+            setParam (Parameters::OVERSAMPLING_NONLINEAR_ONLY, 1.0f);
+            run (100);    // > kFdnTailQuietSeconds of silence
+            expectEquals (processor.getNumBuiltFdnPaths(), 1);
+        }
+
+        beginTest ("CPU per FDN / saturation oversampling setting at high drive");
+        {
+            const char* factorNames[] = { "1x", "2x", "4x", "8x", "16x" };
+            const char* satNames[] = { "Off", "2x", "4x" };
+            constexpr int blockSize = 256;
+            constexpr int numBlocks = 40;
+            const double realTimeMs = 1000.0 * numBlocks * blockSize / 48000.0;
+
+            for (int factor = 0; factor < 5; ++factor)
+            {
+                for (int satStages = 0; satStages < 3; ++satStages)
+                {
+                    WetStringReverbProcessor processor;
+                    auto setParam = [&processor] (const char* id, float value)
+                    {
+                        auto* param = processor.apvts.getParameter (id);
+                        param->setValueNotifyingHost (param->convertTo0to1 (value));
+                    };
+                    setParam (Parameters::OVERSAMPLING, static_cast<float> (factor));
+                    setParam (Parameters::SAT_OVERSAMPLING, static_cast<float> (satStages));
+                    setParam (Parameters::SAT_AMOUNT, 100.0f);
+                    setParam (Parameters::SAT_DRIVE_DB, 24.0f);
+                    processor.prepareToPlay (48000.0, blockSize);
+
+                    juce::AudioBuffer<float> buffer (2, blockSize);
+                    juce::MidiBuffer midi;
+                    uint32_t rng = 11u;
+                    bool finite = true;
+                    double elapsedMs = 0.0;
+
+                    for (int b = 0; b < numBlocks; ++b)
+                    {
+                        for (int ch = 0; ch < 2; ++ch)
+                            for (int i = 0; i < blockSize; ++i)
+                            {
+                                rng = rng * 1664525u + 1013904223u;
+                                buffer.getWritePointer (ch)[i] = 0.2f * ((float) rng / 4294967295.0f - 0.5f);
+                            }
+
+                        const double start = juce::Time::getMillisecondCounterHiRes();
+                        processor.processBlock (buffer, midi);
+                        elapsedMs += juce::Time::getMillisecondCounterHiRes() - start;
+
+                        for (int ch = 0; ch < 2; ++ch)
+                            for (int i = 0; i < blockSize; ++i)
+                                finite = finite && std::isfinite (buffer.getSample (ch, i));
+                    }
+
+                    logMessage (juce::String ("FDN ") + factorNames[factor] + ", saturation OS "
+                                + satNames[satStages] + ": CPU "
+                                + juce::String (100.0 * elapsedMs / realTimeMs, 2) + "% of real time");
+                    expect (finite, juce::String ("Output should stay finite at FDN ") + factorNames[factor]
+                                    + ", saturation OS " + satNames[satStages]);
+                }
+            }
+        }
+
+        beginTest ("Nonlinear-only oversampling runs the loop at base rate");
+        {
+            constexpr int blockSize = 256;
+            constexpr int numBlocks = 200;
+            const double realTimeMs = 1000.0 * numBlocks * blockSize / 48000.0;
+
+            struct Run { int latency; double rms; double elapsedMs; bool finite; };
+            auto render = [&] (bool nonlinearOnly)
+            {
+                WetStringReverbProcessor processor;
+                auto setParam = [&processor] (const char* id, float value)
+                {
+                    auto* param = processor.apvts.getParameter (id);
+                    param->setValueNotifyingHost (param->convertTo0to1 (value));
+                };
+                setParam (Parameters::OVERSAMPLING, 2.0f);
+                setParam (Parameters::OVERSAMPLING_NONLINEAR_ONLY, nonlinearOnly ? 1.0f : 0.0f);
+                setParam (Parameters::SAT_AMOUNT, 100.0f);
+                setParam (Parameters::SAT_DRIVE_DB, 24.0f);
+                processor.prepareToPlay (48000.0, blockSize);
+
+                juce::AudioBuffer<float> buffer (2, blockSize);
+                juce::MidiBuffer midi;
+                uint32_t rng = 5u;
+                Run run { processor.getLatencySamples(), 0.0, 0.0, true };
+                double sumSq = 0.0;
+
+                for (int b = 0; b < numBlocks; ++b)
+                {
+                    for (int ch = 0; ch < 2; ++ch)
+                        for (int i = 0; i < blockSize; ++i)
+                        {
+                            rng = rng * 1664525u + 1013904223u;
+                            buffer.getWritePointer (ch)[i] = 0.2f * ((float) rng / 4294967295.0f - 0.5f);
+                        }
+
+                    const double start = juce::Time::getMillisecondCounterHiRes();
+                    processor.processBlock (buffer, midi);
+                    run.elapsedMs += juce::Time::getMillisecondCounterHiRes() - start;
+
+                    for (int ch = 0; ch < 2; ++ch)
+                        for (int i = 0; i < blockSize; ++i)
+                        {
+                            const float x = buffer.getSample (ch, i);
+                            run.finite = run.finite && std::isfinite (x);
+                            if (b >= numBlocks / 2)
+                                sumSq += (double) x * x;
+                        }
+                }
+
+                run.rms = std::sqrt (sumSq / (numBlocks / 2 * blockSize * 2));
+                return run;
+            };
+
+            const auto fullLoop = render (false);
+            const auto nonlinear = render (true);
+            const double levelDiffDb = 20.0 * std::log10 (nonlinear.rms / fullLoop.rms);
+
+            logMessage ("4x full loop: CPU " + juce::String (100.0 * fullLoop.elapsedMs / realTimeMs, 2)
+                        + "%, nonlinear only: CPU " + juce::String (100.0 * nonlinear.elapsedMs / realTimeMs, 2)
+                        + "%, level difference " + juce::String (levelDiffDb, 2) + " dB");
+
+            expect (fullLoop.finite && nonlinear.finite, "Output should stay finite");
+            expectEquals (nonlinear.latency, fullLoop.latency);
+            expect (std::abs (levelDiffDb) < 3.0,
+                "Nonlinear-only level should match the full loop, difference " + juce::String (levelDiffDb) + " dB");
         }
 
-        // 9 パターン（SR × OS）全組合せ
+        // 15 パターン（SR × OS）全組合せ
         const std::array<double, 3> sampleRates = { 44100.0, 48000.0, 96000.0 };
-        const std::array<int, 3> osFactors = { 0, 1, 2 };
+        const std::array<int, 5> osFactors = { 0, 1, 2, 3, 4 };
 
         for (auto sr : sampleRates)
         {
@@ -90,19 +484,19 @@ public:
             juce::AudioBuffer<float> buffer (2, 512);
             juce::MidiBuffer midi;
 
-            // Off → 2x → 4x → Off の切替
-            std::array<int, 4> factors = { 0, 1, 2, 0 };
+            // Off → 2x → 4x → 16x → 8x → Off の切替
+            std::array<int, 6> factors = { 0, 1, 2, 4, 3, 0 };
             for (auto f : factors)
             {
                 auto* param = processor.apvts.getParameter (Parameters::OVERSAMPLING);
                 if (param != nullptr)
-                    param->setValueNotifyingHost (
-                        static_cast<float> (f) / 2.0f);
+                    param->setValueNotifyingHost (param->convertTo0to1 (static_cast<float> (f)));
 
                 buffer.clear();
                 buffer.getWritePointer (0)[0] = 0.5f;
                 buffer.getWritePointer (1)[0] = 0.5f;
                 processor.processBlock (buffer, midi);
+                processor.handleUpdateNowIfNeeded();    // メッセージスレッドでのパス構築
 
                 // NaN/Inf チェック
                 for (int ch = 0; ch < 2; ++ch)
@@ -128,7 +522,7 @@ private:
         // OS パラメータを設定してから prepare
         auto* param = processor.apvts.getParameter (Parameters::OVERSAMPLING);
         if (param != nullptr)
-            param->setValueNotifyingHost (static_cast<float> (factor) / 2.0f);
+            param->setValueNotifyingHost (param->convertTo0to1 (static_cast<float> (factor)));
 
         processor.prepareToPlay (sampleRate, blockSize);
 
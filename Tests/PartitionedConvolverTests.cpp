@@ -0,0 +1,120 @@
+#include <juce_audio_processors/juce_audio_processors.h>
+#include "../Source/DSP/PartitionedConvolver.h"
+#include <cmath>
+#include <vector>
+
+//==============================================================================
+class PartitionedConvolverTests : public juce::UnitTest
+{
+public:
+    PartitionedConvolverTests() : juce::UnitTest ("Partitioned Convolver Tests") {}
+
+    void runTest() override
+    {
+        beginTest ("Matches direct convolution delayed by one partition");
+        {
+            const int irLength = 1000;
+            const int total = 4096;
+
+            uint32_t rng = 12345u;
+            auto noise = [&rng]
+            {
+                rng = rng * 1664525u + 1013904223u;
+                return static_cast<float> (rng) / 4294967295.0f - 0.5f;
+            };
+
+            std::vector<float> ir ((size_t) irLength), input ((size_t) total);
+            for (auto& h : ir)    h = noise() * 0.1f;
+            for (auto& x : input) x = noise();
+
+            DSP::PartitionedConvolver conv;
+            conv.prepare (100, irLength);    // rounded up to 128
+            conv.setImpulseResponse (ir.data(), irLength);
+            expectEquals (conv.getLatency(), 128);
+            expectEquals (conv.getNumPartitions(), 8);
+
+            // Irregular block sizes exercise the input FIFO
+            std::vector<float> output ((size_t) total, 0.0f);
+            const int blockSizes[] = { 1, 37, 128, 200, 5, 64 };
+            int pos = 0, b = 0;
+            while (pos < total)
+            {
+                const int n = std::min (blockSizes[b++ % 6], total - pos);
+                conv.process (input.data() + pos, output.data() + pos, n);
+                pos += n;
+            }
+
+            float maxError = 0.0f;
+            for (int t = 0; t < total; ++t)
+            {
+                double expected = 0.0;
+                const int src = t - conv.getLatency();
+                for (int k = 0; k < irLength && k <= src; ++k)
+                    expected += (double) ir[(size_t) k] * (double) input[(size_t) (src - k)];
+                maxError = std::max (maxError, std::abs (output[(size_t) t] - (float) expected));
+            }
+
+            expect (maxError < 1.0e-4f, "FFT convolution error " + juce::String (maxError));
+        }
+
+        beginTest ("Staged impulse response swaps in only when complete");
+        {
+            const int irLength = 64 * 40;
+            std::vector<float> first ((size_t) irLength, 0.0f), second ((size_t) irLength, 0.0f);
+            first[0] = 1.0f;
+            second[0] = -1.0f;
+
+            DSP::PartitionedConvolver conv;
+            conv.prepare (64, irLength);
+            conv.setImpulseResponse (first.data(), irLength);
+
+            conv.loadImpulseResponse (second.data(), irLength);
+            expect (! conv.advanceImpulseResponseUpdate (10), "40 partitions cannot finish in 10");
+            expect (conv.isUpdatePending());
+
+            // Still the old IR
+            std::vector<float> in (64, 0.0f), out (64, 0.0f);
+            in[0] = 1.0f;
+            conv.process (in.data(), out.data(), 64);
+            std::fill (in.begin(), in.end(), 0.0f);
+            conv.process (in.data(), out.data(), 64);
+            expectWithinAbsoluteError (out[0], 1.0f, 1.0e-5f);
+
+            while (! conv.advanceImpulseResponseUpdate (10)) {}
+            expect (! conv.isUpdatePending());
+
+            conv.reset();
+            in[0] = 1.0f;
+            conv.process (in.data(), out.data(), 64);
+            in[0] = 0.0f;
+            conv.process (in.data(), out.data(), 64);
+            expectWithinAbsoluteError (out[0], -1.0f, 1.0e-5f);
+        }
+
+        beginTest ("Staging buffer is scaled on commit and left empty");
+        {
+            const int irLength = 64 * 8;
+            DSP::PartitionedConvolver conv;
+            conv.prepare (64, irLength);
+
+            float* staging = conv.getStagingBuffer();
+            staging[3] = 2.0f;
+            staging[200] = -1.0f;
+            conv.commitStagedImpulseResponse (irLength, 0.25f);
+            while (! conv.advanceImpulseResponseUpdate (1)) {}
+
+            bool empty = true;
+            for (int i = 0; i < conv.getMaxImpulseLength(); ++i)
+                empty = empty && conv.getStagingBuffer()[i] == 0.0f;
+            expect (empty, "Transformed partitions should be cleared");
+
+            std::vector<float> in ((size_t) (irLength + 64), 0.0f), out (in.size(), 0.0f);
+            in[0] = 1.0f;
+            conv.process (in.data(), out.data(), (int) in.size());
+            expectWithinAbsoluteError (out[64 + 3], 0.5f, 1.0e-5f);
+            expectWithinAbsoluteError (out[64 + 200], -0.25f, 1.0e-5f);
+        }
+    }
+};
+
+static PartitionedConvolverTests partitionedConvolverTests;
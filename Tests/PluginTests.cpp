@@ -15,20 +15,25 @@ public:
         WetStringReverbProcessor processor;
         auto& apvts = processor.apvts;
 
-        beginTest ("All 19 parameters exist in APVTS");
+        beginTest ("All 31 parameters exist in APVTS");
         {
             const char* paramIds[] = {
                 Parameters::DRY_WET, Parameters::PRE_DELAY_MS,
                 Parameters::EARLY_LEVEL_DB, Parameters::LATE_LEVEL_DB,
                 Parameters::ROOM_SIZE, Parameters::STEREO_WIDTH,
-                Parameters::OVERSAMPLING,
+                Parameters::OVERSAMPLING, Parameters::OVERSAMPLING_FILTER,
                 Parameters::LOW_RT60_S, Parameters::HIGH_RT60_S,
                 Parameters::HF_DAMPING, Parameters::DIFFUSION,
-                Parameters::DECAY_SHAPE,
+                Parameters::DECAY_SHAPE, Parameters::FDN_ROUTING,
+                Parameters::ER_LENGTH_MS, Parameters::ER_DENSITY,
                 Parameters::SAT_AMOUNT, Parameters::SAT_DRIVE_DB,
                 Parameters::SAT_TYPE, Parameters::SAT_TONE,
-                Parameters::SAT_ASYMMETRY,
-                Parameters::MOD_DEPTH, Parameters::MOD_RATE_HZ
+                Parameters::SAT_ASYMMETRY, Parameters::SAT_ANTIALIAS,
+                Parameters::SAT_OVERSAMPLING,
+                Parameters::MOD_DEPTH, Parameters::MOD_RATE_HZ,
+                Parameters::DVN_HALF_RATE, Parameters::OVERSAMPLING_AUTO,
+                Parameters::OVERSAMPLING_NONLINEAR_ONLY, Parameters::OUTPUT_CLIP_ADAA,
+                Parameters::PARALLEL_LAYERS, Parameters::DVN_PIPELINED
             };
 
             int count = 0;
@@ -39,7 +44,7 @@ public:
                 if (param != nullptr)
                     ++count;
             }
-            expect (count == 19, "Expected 19 parameters, got " + juce::String (count));
+            expect (count == 31, "Expected 31 parameters, got " + juce::String (count));
         }
 
         beginTest ("Default values are correct");
@@ -65,12 +70,27 @@ public:
             checkDefault (Parameters::HF_DAMPING, 65.0f);
             checkDefault (Parameters::DIFFUSION, 80.0f);
             checkDefault (Parameters::DECAY_SHAPE, 40.0f);
+            checkDefault (Parameters::ER_LENGTH_MS, 30.0f);
+            checkDefault (Parameters::ER_DENSITY, 2000.0f, 1.0f);
             checkDefault (Parameters::SAT_AMOUNT, 0.0f);
             checkDefault (Parameters::SAT_DRIVE_DB, 6.0f);
             checkDefault (Parameters::SAT_TONE, 0.0f);
             checkDefault (Parameters::SAT_ASYMMETRY, 0.0f);
             checkDefault (Parameters::MOD_DEPTH, 15.0f);
             checkDefault (Parameters::MOD_RATE_HZ, 0.5f);
+
+            // Choices report their index, switches 0 / 1
+            checkDefault (Parameters::OVERSAMPLING, 1.0f);
+            checkDefault (Parameters::OVERSAMPLING_FILTER, 1.0f);
+            checkDefault (Parameters::FDN_ROUTING, 0.0f);
+            checkDefault (Parameters::SAT_ANTIALIAS, 0.0f);
+            checkDefault (Parameters::SAT_OVERSAMPLING, 0.0f);
+            checkDefault (Parameters::DVN_HALF_RATE, 0.0f);
+            checkDefault (Parameters::OVERSAMPLING_AUTO, 0.0f);
+            checkDefault (Parameters::OVERSAMPLING_NONLINEAR_ONLY, 0.0f);
+            checkDefault (Parameters::OUTPUT_CLIP_ADAA, 0.0f);
+            checkDefault (Parameters::PARALLEL_LAYERS, 0.0f);
+            checkDefault (Parameters::DVN_PIPELINED, 0.0f);
         }
 
         beginTest ("Parameter ranges are correct");
@@ -96,6 +116,8 @@ public:
             checkRange (Parameters::LOW_RT60_S, 0.2f, 12.0f);
             checkRange (Parameters::HIGH_RT60_S, 0.1f, 8.0f);
             checkRange (Parameters::HF_DAMPING, 0.0f, 100.0f);
+            checkRange (Parameters::ER_LENGTH_MS, 10.0f, 80.0f);
+            checkRange (Parameters::ER_DENSITY, 500.0f, 4000.0f);
             checkRange (Parameters::SAT_AMOUNT, 0.0f, 100.0f);
             checkRange (Parameters::SAT_DRIVE_DB, 0.0f, 24.0f);
             checkRange (Parameters::SAT_TONE, -100.0f, 100.0f);
@@ -106,13 +128,13 @@ public:
 
         beginTest ("Choice parameters have correct options");
         {
-            // Oversampling: Off, 2x, 4x
+            // Oversampling: Off, 2x, 4x, 8x, 16x
             auto* osParam = dynamic_cast<juce::AudioParameterChoice*> (
                 apvts.getParameter (Parameters::OVERSAMPLING));
             expect (osParam != nullptr, "Oversampling should be AudioParameterChoice");
             if (osParam != nullptr)
             {
-                expect (osParam->choices.size() == 3, "Oversampling should have 3 choices");
+                expect (osParam->choices.size() == 5, "Oversampling should have 5 choices");
                 expect (osParam->getIndex() == 1, "Oversampling default should be 2x (index 1)");
             }
 
@@ -125,6 +147,46 @@ public:
                 expect (satParam->choices.size() == 4, "SatType should have 4 choices");
                 expect (satParam->getIndex() == 1, "SatType default should be Warm (index 1)");
             }
+
+            // Saturation anti-aliasing: Off, ADAA 1, ADAA 2
+            auto* aaParam = dynamic_cast<juce::AudioParameterChoice*> (
+                apvts.getParameter (Parameters::SAT_ANTIALIAS));
+            expect (aaParam != nullptr, "SatAntiAlias should be AudioParameterChoice");
+            if (aaParam != nullptr)
+            {
+                expect (aaParam->choices.size() == 3, "SatAntiAlias should have 3 choices");
+                expect (aaParam->getIndex() == 0, "SatAntiAlias default should be Off (index 0)");
+            }
+
+            // Oversampling filter: Low Latency IIR, IIR, Linear Phase FIR
+            auto* osFilterParam = dynamic_cast<juce::AudioParameterChoice*> (
+                apvts.getParameter (Parameters::OVERSAMPLING_FILTER));
+            expect (osFilterParam != nullptr, "OversamplingFilter should be AudioParameterChoice");
+            if (osFilterParam != nullptr)
+            {
+                expect (osFilterParam->choices.size() == 3, "OversamplingFilter should have 3 choices");
+                expect (osFilterParam->getIndex() == 1, "OversamplingFilter default should be IIR (index 1)");
+            }
+
+            // Saturation oversampling: Off, 2x, 4x
+            auto* satOsParam = dynamic_cast<juce::AudioParameterChoice*> (
+                apvts.getParameter (Parameters::SAT_OVERSAMPLING));
+            expect (satOsParam != nullptr, "SatOversampling should be AudioParameterChoice");
+            if (satOsParam != nullptr)
+            {
+                expect (satOsParam->choices.size() == 3, "SatOversampling should have 3 choices");
+                expect (satOsParam->getIndex() == 0, "SatOversampling default should be Off (index 0)");
+            }
+
+            // FDN routing: Stereo, Mid/Side, Mono In
+            auto* routingParam = dynamic_cast<juce::AudioParameterChoice*> (
+                apvts.getParameter (Parameters::FDN_ROUTING));
+            expect (routingParam != nullptr, "FdnRouting should be AudioParameterChoice");
+            if (routingParam != nullptr)
+            {
+                expect (routingParam->choices.size() == 3, "FdnRouting should have 3 choices");
+                expect (routingParam->getIndex() == 0, "FdnRouting default should be Stereo (index 0)");
+            }
         }
     }
 };
@@ -0,0 +1,114 @@
+#include <juce_audio_processors/juce_audio_processors.h>
+#include "../Source/DSP/PreDelay.h"
+#include <cmath>
+#include <vector>
+
+//==============================================================================
+class PreDelayTests : public juce::UnitTest
+{
+public:
+    PreDelayTests() : juce::UnitTest ("Pre-Delay Tests") {}
+
+    void runTest() override
+    {
+        beginTest ("Static pre-delay is an exact integer delay across ring wrap");
+        {
+            const int blockSize = 96;
+            const int delay = 250;
+
+            DSP::PreDelay pd;
+            pd.prepare (2, 300, blockSize, 480);
+
+            std::vector<float> inL (blockSize), inR (blockSize), outL (blockSize), outR (blockSize);
+            std::vector<float> history;
+
+            float maxError = 0.0f;
+            for (int b = 0; b < 30; ++b)
+            {
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    const float x = std::sin (0.01f * static_cast<float> (b * blockSize + i));
+                    inL[(size_t) i] = x;
+                    inR[(size_t) i] = -x;
+                    history.push_back (x);
+                }
+
+                const float* ins[2] = { inL.data(), inR.data() };
+                float* outs[2] = { outL.data(), outR.data() };
+                pd.process (ins, outs, blockSize, delay);
+
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    const int t = b * blockSize + i - delay;
+                    const float expected = t >= 0 ? history[(size_t) t] : 0.0f;
+                    maxError = std::max (maxError, std::abs (outL[(size_t) i] - expected));
+                    maxError = std::max (maxError, std::abs (outR[(size_t) i] + expected));
+                }
+            }
+
+            expectEquals (maxError, 0.0f, "Static delay must be sample-exact");
+        }
+
+        beginTest ("Processing in place is supported");
+        {
+            const int blockSize = 64;
+            DSP::PreDelay pd;
+            pd.prepare (1, 100, blockSize, 64);
+
+            std::vector<float> buf (blockSize, 0.0f);
+            buf[0] = 1.0f;
+
+            int impulseAt = -1;
+            for (int b = 0; b < 4; ++b)
+            {
+                const float* ins[1] = { buf.data() };
+                float* outs[1] = { buf.data() };
+                pd.process (ins, outs, blockSize, 70);
+
+                for (int i = 0; i < blockSize; ++i)
+                    if (buf[(size_t) i] == 1.0f)
+                        impulseAt = b * blockSize + i;
+
+                std::fill (buf.begin(), buf.end(), 0.0f);
+            }
+
+            expectEquals (impulseAt, 70);
+        }
+
+        beginTest ("Delay change crossfades between read positions");
+        {
+            const int blockSize = 64;
+            const int fade = 256;
+
+            DSP::PreDelay pd;
+            pd.prepare (1, 1000, blockSize, fade);
+
+            // DC input: any discontinuity would show up as a step
+            std::vector<float> in (blockSize, 1.0f), out (blockSize);
+            const float* ins[1] = { in.data() };
+            float* outs[1] = { out.data() };
+
+            for (int b = 0; b < 5; ++b)
+                pd.process (ins, outs, blockSize, 100);
+
+            // Jump into the silent (not yet written) region of the history
+            float maxStep = 0.0f;
+            float previous = out[(size_t) blockSize - 1];
+            for (int b = 0; b < 8; ++b)
+            {
+                pd.process (ins, outs, blockSize, 900 + b);   // further changes wait for the fade
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    maxStep = std::max (maxStep, std::abs (out[(size_t) i] - previous));
+                    previous = out[(size_t) i];
+                }
+            }
+
+            expect (maxStep <= 1.0f / static_cast<float> (fade) + 1.0e-6f,
+                "Output should ramp, largest step " + juce::String (maxStep));
+            expectEquals (pd.getCurrentDelay(), 904, "Next change should start after the fade");
+        }
+    }
+};
+
+static PreDelayTests preDelayTests;
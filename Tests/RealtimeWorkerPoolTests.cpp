@@ -0,0 +1,163 @@
+#include <juce_audio_processors/juce_audio_processors.h>
+#include "../Source/DSP/RealtimeWorkerPool.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+//==============================================================================
+class RealtimeWorkerPoolTests : public juce::UnitTest
+{
+public:
+    RealtimeWorkerPoolTests() : juce::UnitTest ("Realtime Worker Pool Tests") {}
+
+    void runTest() override
+    {
+        beginTest ("Every job of every batch runs exactly once");
+        {
+            DSP::RealtimeWorkerPool pool;
+            pool.start (3);
+            expectEquals (pool.getNumWorkers(), std::min (3, DSP::RealtimeWorkerPool::getMaxUsefulWorkers()));
+
+            struct Counter
+            {
+                std::atomic<int> runs { 0 };
+                int spin = 0;
+            };
+            std::array<Counter, 6> counters;
+            std::array<DSP::RealtimeWorkerPool::Job, 6> jobs;
+            for (size_t i = 0; i < jobs.size(); ++i)
+            {
+                counters[i].spin = 200 * static_cast<int> (i + 1);
+                jobs[i] = { [] (void* context)
+                            {
+                                auto& counter = *static_cast<Counter*> (context);
+                                volatile float sink = 0.0f;
+                                for (int k = 0; k < counter.spin; ++k)
+                                    sink = sink + 1.0f;
+                                counter.runs.fetch_add (1);
+                            },
+                            &counters[i] };
+            }
+
+            constexpr int numBatches = 2000;
+            bool allComplete = true;
+            for (int batch = 0; batch < numBatches; ++batch)
+            {
+                const int numJobs = 1 + batch % 6;
+                pool.launch (jobs.data(), numJobs);
+                pool.wait();
+
+                // wait() returns only once the whole batch has run
+                int total = 0;
+                for (auto& counter : counters)
+                    total += counter.runs.load();
+                int expected = 0;
+                for (int b = 0; b <= batch; ++b)
+                    expected += 1 + b % 6;
+                allComplete = allComplete && total == expected;
+            }
+
+            expect (allComplete, "A batch was still running after wait()");
+            for (size_t i = 0; i < counters.size(); ++i)
+            {
+                int expected = 0;
+                for (int b = 0; b < numBatches; ++b)
+                    expected += (1 + b % 6) > static_cast<int> (i) ? 1 : 0;
+                expectEquals (counters[i].runs.load(), expected);
+            }
+
+            pool.stop();
+            expectEquals (pool.getNumWorkers(), 0);
+        }
+
+        beginTest ("A blocked worker is woken by launch()");
+        {
+            DSP::RealtimeWorkerPool pool;
+            pool.start (1);
+            std::this_thread::sleep_for (std::chrono::milliseconds (50));    // past the spin phase
+
+            struct Record
+            {
+                std::atomic<bool> ran { false };
+                std::thread::id thread;
+            } record;
+            const DSP::RealtimeWorkerPool::Job job { [] (void* context)
+                                                     {
+                                                         auto& r = *static_cast<Record*> (context);
+                                                         r.thread = std::this_thread::get_id();
+                                                         r.ran.store (true);
+                                                     },
+                                                     &record };
+
+            pool.launch (&job, 1);
+            for (int i = 0; i < 1000 && ! record.ran.load(); ++i)
+                std::this_thread::sleep_for (std::chrono::milliseconds (1));
+            expect (record.ran.load(), "The worker should have picked up the job on its own");
+            pool.wait();
+            expect (record.thread != std::this_thread::get_id());
+
+            pool.stop();
+            expectEquals (pool.getNumWorkers(), 0);
+        }
+
+        beginTest ("The pool is sized to the cores beside the caller");
+        {
+            DSP::RealtimeWorkerPool pool;
+            pool.start (DSP::RealtimeWorkerPool::MAX_WORKERS);
+            expectEquals (pool.getNumWorkers(), DSP::RealtimeWorkerPool::getMaxUsefulWorkers());
+            expect (pool.getNumWorkers() < juce::SystemStats::getNumCpus());
+        }
+
+        beginTest ("wait() outlasts its spin for a long job on a worker");
+        {
+            DSP::RealtimeWorkerPool pool;
+            pool.start (1);
+            if (pool.getNumWorkers() == 1)
+            {
+                struct Record
+                {
+                    std::atomic<bool> started { false };
+                    std::atomic<bool> done { false };
+                } record;
+                const DSP::RealtimeWorkerPool::Job job { [] (void* context)
+                                                         {
+                                                             auto& r = *static_cast<Record*> (context);
+                                                             r.started.store (true);
+                                                             std::this_thread::sleep_for (std::chrono::milliseconds (30));
+                                                             r.done.store (true);
+                                                         },
+                                                         &record };
+
+                // Let the worker take it, so wait() has to sleep on it
+                pool.launch (&job, 1);
+                for (int i = 0; i < 1000 && ! record.started.load(); ++i)
+                    std::this_thread::sleep_for (std::chrono::milliseconds (1));
+
+                pool.wait();
+                expect (record.done.load(), "wait() returned before the worker finished");
+
+                // The next batch still completes normally
+                record.started.store (false);
+                record.done.store (false);
+                pool.launch (&job, 1);
+                pool.wait();
+                expect (record.done.load());
+            }
+        }
+
+        beginTest ("Without workers wait() runs the batch on the calling thread");
+        {
+            DSP::RealtimeWorkerPool pool;
+            int runs = 0;
+            const DSP::RealtimeWorkerPool::Job job { [] (void* context) { ++*static_cast<int*> (context); }, &runs };
+
+            pool.launch (&job, 1);
+            expectEquals (runs, 0);
+            pool.wait();
+            expectEquals (runs, 1);
+        }
+    }
+};
+
+static RealtimeWorkerPoolTests realtimeWorkerPoolTests;
@@ -1,7 +1,11 @@
 #include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_dsp/juce_dsp.h>
 #include "../Source/DSP/Saturation.h"
+#include "../Source/DSP/HalfbandResampler.h"
+#include "../Source/DSP/SaturationOversampler.h"
 #include <cmath>
 #include <array>
+#include <vector>
 
 //==============================================================================
 class SaturationTests : public juce::UnitTest
@@ -195,9 +199,281 @@ public:
             expectWithinAbsoluteError (output, 0.0f, 0.001f,
                 "After reset, zero input should produce near-zero output");
         }
+
+        beginTest ("FastMath::tanh stays within its documented error bound");
+        {
+            float maxError = 0.0f, maxErrorNear = 0.0f, maxAbs = 0.0f;
+            for (int i = -400000; i <= 400000; ++i)
+            {
+                const float x = static_cast<float> (i) * 5.0e-5f;   // -20 .. 20
+                const float y = DSP::FastMath::tanh (x);
+                const float e = std::abs (y - std::tanh (x));
+                maxError = std::max (maxError, e);
+                maxAbs = std::max (maxAbs, std::abs (y));
+                if (std::abs (x) < 2.0f)
+                    maxErrorNear = std::max (maxErrorNear, e);
+            }
+
+            expect (maxError < 1.0e-4f, "Max error " + juce::String (maxError));
+            expect (maxErrorNear < 1.0e-6f, "Max error for |x| < 2 " + juce::String (maxErrorNear));
+            expect (maxAbs <= 1.0f, "Output must stay within [-1, 1]");
+        }
+
+        beginTest ("Per-type kernels match the std::tanh reference curves");
+        {
+            float maxError = 0.0f;
+            for (int i = -20000; i <= 20000; ++i)
+            {
+                const float x = static_cast<float> (i) * 5.0e-4f;   // -10 .. 10
+                const float tape = x >= 0.0f ? std::tanh (x) : 1.25f * std::tanh (0.8f * x);
+                const float tube = std::tanh ((x >= 0.0f ? 1.2f : 0.8f) * x);
+
+                maxError = std::max (maxError, std::abs (DSP::Saturation::shape<DSP::Saturation::Type::Warm> (x) - std::tanh (x)));
+                maxError = std::max (maxError, std::abs (DSP::Saturation::shape<DSP::Saturation::Type::Tape> (x) - tape));
+                maxError = std::max (maxError, std::abs (DSP::Saturation::shape<DSP::Saturation::Type::Tube> (x) - tube));
+            }
+
+            // Tape's negative side scales the approximation error by 1.25
+            expect (maxError < 1.25e-4f, "Max kernel error " + juce::String (maxError));
+        }
+
+        beginTest ("processBlock matches per-sample process for every type");
+        {
+            for (int typeIndex = 0; typeIndex < 4; ++typeIndex)
+            {
+                DSP::Saturation perSample, block;
+                for (auto* s : { &perSample, &block })
+                {
+                    s->prepare (48000.0);
+                    s->setParameters (70.0f, 18.0f, typeIndex, 40.0f);
+                    s->reset();
+                }
+
+                const int total = 1000;
+                std::vector<float> expected ((size_t) total), buffer ((size_t) total);
+                for (int i = 0; i < total; ++i)
+                {
+                    const float x = 0.8f * std::sin (0.031f * static_cast<float> (i));
+                    buffer[(size_t) i] = x;
+                    expected[(size_t) i] = perSample.process (x);
+                }
+
+                // In place, block sizes that straddle the internal chunking
+                const int blockSizes[] = { 1, 100, 63, 200, 7 };
+                int pos = 0, b = 0;
+                while (pos < total)
+                {
+                    const int n = std::min (blockSizes[b++ % 5], total - pos);
+                    block.processBlock (buffer.data() + pos, buffer.data() + pos, n);
+                    pos += n;
+                }
+
+                float maxDiff = 0.0f;
+                for (int i = 0; i < total; ++i)
+                    maxDiff = std::max (maxDiff, std::abs (buffer[(size_t) i] - expected[(size_t) i]));
+
+                expect (maxDiff < 1.0e-6f, "Type " + juce::String (typeIndex)
+                                           + " block/sample difference " + juce::String (maxDiff));
+            }
+        }
+
+        beginTest ("ADAA antiderivatives differentiate back to the curves");
+        {
+            checkAntiderivatives<DSP::Saturation::Type::Soft> ("Soft");
+            checkAntiderivatives<DSP::Saturation::Type::Warm> ("Warm");
+            checkAntiderivatives<DSP::Saturation::Type::Tape> ("Tape");
+            checkAntiderivatives<DSP::Saturation::Type::Tube> ("Tube");
+        }
+
+        beginTest ("ADAA at 1x reduces aliasing to the level of the 2x oversampled path");
+        {
+            const char* names[] = { "Soft", "Warm", "Tape", "Tube" };
+            for (int typeIndex = 0; typeIndex < 4; ++typeIndex)
+            {
+                const double naive = measureAliasing (typeIndex, 0, false);
+                const double adaa1 = measureAliasing (typeIndex, 1, false);
+                const double adaa2 = measureAliasing (typeIndex, 2, false);
+                const double os2x  = measureAliasing (typeIndex, 0, true);
+
+                const juce::String info = juce::String (names[typeIndex])
+                    + ": naive " + juce::String (naive, 1) + " dB, ADAA1 " + juce::String (adaa1, 1)
+                    + " dB, ADAA2 " + juce::String (adaa2, 1) + " dB, 2x " + juce::String (os2x, 1) + " dB";
+
+                expect (adaa1 < naive - 4.0, info);
+                expect (adaa2 < adaa1 - 4.0, info);
+                expect (adaa2 < os2x + 4.0, info);
+            }
+        }
+
+        beginTest ("Local 4x oversampling aliases less than 2x, and 2x less than 1x");
+        {
+            const char* names[] = { "Soft", "Warm", "Tape", "Tube" };
+            for (int typeIndex = 0; typeIndex < 4; ++typeIndex)
+            {
+                const double naive = measureLocalOversamplingAliasing (typeIndex, 0);
+                const double os2x  = measureLocalOversamplingAliasing (typeIndex, 1);
+                const double os4x  = measureLocalOversamplingAliasing (typeIndex, 2);
+
+                const juce::String info = juce::String (names[typeIndex])
+                    + ": 1x " + juce::String (naive, 1) + " dB, 2x " + juce::String (os2x, 1)
+                    + " dB, 4x " + juce::String (os4x, 1) + " dB";
+
+                expect (os2x < naive - 6.0, info);
+                expect (os4x < os2x - 6.0, info);
+            }
+        }
+
+        beginTest ("Saturation oversampler latency matches the halfband stages");
+        {
+            DSP::SaturationOversampler<1> oversampler;
+            expectEquals (oversampler.getLatency(), 0.0f);
+
+            oversampler.prepare (1);
+            expectEquals (oversampler.getFactor(), 2);
+            expectEquals (oversampler.getLatency(), static_cast<float> (DSP::HalfbandCoefficients::LATENCY));
+
+            // Inner stages use the short halfband
+            const float first = static_cast<float> (DSP::HalfbandCoefficients::LATENCY);
+            const float inner = static_cast<float> (DSP::ShortHalfbandCoefficients::LATENCY);
+
+            oversampler.prepare (2);
+            expectEquals (oversampler.getFactor(), 4);
+            expectEquals (oversampler.getLatency(), first + 0.5f * inner);
+
+            oversampler.prepare (4);
+            expectEquals (oversampler.getFactor(), 16);
+            expectEquals (oversampler.getLatency(), first + 0.875f * inner);
+        }
     }
 
 private:
+    template <DSP::Saturation::Type T>
+    void checkAntiderivatives (const char* typeName)
+    {
+        const double h = 1.0e-4;
+        double maxError1 = 0.0, maxError2 = 0.0;
+        for (int i = -6000; i <= 6000; ++i)
+        {
+            const double x = static_cast<double> (i) * 1.0e-3 + 0.5e-4;   // -6 .. 6, off the kinks
+            const double d1 = (DSP::Saturation::antiderivative1<T> (x + h)
+                             - DSP::Saturation::antiderivative1<T> (x - h)) / (2.0 * h);
+            const double d2 = (DSP::Saturation::antiderivative2<T> (x + h)
+                             - DSP::Saturation::antiderivative2<T> (x - h)) / (2.0 * h);
+            maxError1 = std::max (maxError1, std::abs (d1 - DSP::Saturation::shape<T> (static_cast<float> (x))));
+            maxError2 = std::max (maxError2, std::abs (d2 - DSP::Saturation::antiderivative1<T> (x)));
+        }
+
+        // F1' is compared with the fast-tanh curve, hence the looser bound
+        expect (maxError1 < 2.0e-4, juce::String (typeName) + " F1' error " + juce::String (maxError1));
+        expect (maxError2 < 1.0e-6, juce::String (typeName) + " F2' error " + juce::String (maxError2));
+    }
+
+    static constexpr int kAliasOrder = 12;
+    static constexpr int kAliasBin = 437;    // cycle count in 2^kAliasOrder: exactly periodic
+
+    static float aliasTestInput (int i)
+    {
+        return 0.5f * static_cast<float> (std::sin (2.0 * 3.14159265358979323846
+                                                    * kAliasBin * i / (1 << kAliasOrder)));
+    }
+
+    /**
+     * Non-harmonic to harmonic power (dB) of a saturated 5.1 kHz sine at
+     * 48 kHz: everything off the harmonic bins is aliasing.  With
+     * oversample2x the curve runs at 96 kHz between halfband stages.
+     */
+    double measureAliasing (int typeIndex, int antiAliasMode, bool oversample2x)
+    {
+        constexpr int N = 1 << kAliasOrder;
+        const int total = 4 * N;
+
+        DSP::Saturation sat;
+        sat.prepare (oversample2x ? 96000.0 : 48000.0);
+        sat.setParameters (100.0f, 18.0f, typeIndex, 0.0f);
+        sat.setAntiAliasing (antiAliasMode);
+        sat.reset();
+
+        std::vector<float> input ((size_t) total), output ((size_t) total);
+        for (int i = 0; i < total; ++i)
+            input[(size_t) i] = aliasTestInput (i);
+
+        if (oversample2x)
+        {
+            DSP::HalfbandInterpolator up;
+            DSP::HalfbandDecimator down;
+            up.reset();
+            down.reset();
+
+            std::vector<float> high ((size_t) (2 * total));
+            up.process (input.data(), high.data(), 2 * total);
+            sat.processBlock (high.data(), high.data(), 2 * total);
+            down.process (high.data(), 2 * total, output.data());
+        }
+        else
+        {
+            sat.processBlock (input.data(), output.data(), total);
+        }
+
+        return aliasToHarmonicDb (output, N / 2);
+    }
+
+    /**
+     * The same measurement through a SaturationOversampler, as in the FDN
+     * loop, counting aliasing below 16 kHz only: above that the last
+     * decimator's transition band folds back whatever the factor.
+     */
+    double measureLocalOversamplingAliasing (int typeIndex, int oversamplingStages)
+    {
+        constexpr int N = 1 << kAliasOrder;
+        const int total = 4 * N;
+
+        std::array<DSP::Saturation, 1> sat;
+        DSP::SaturationOversampler<1> oversampler;
+        oversampler.prepare (oversamplingStages);
+        sat[0].prepare (48000.0 * oversampler.getFactor());
+        sat[0].setParameters (100.0f, 18.0f, typeIndex, 0.0f);
+        sat[0].reset();
+
+        std::vector<float> output ((size_t) total);
+        for (int i = 0; i < total; ++i)
+        {
+            const std::array<float, 1> in { aliasTestInput (i) };
+            std::array<float, 1> out {};
+            if (oversamplingStages > 0)
+                oversampler.processFrame (sat, in, out);
+            else
+                DSP::Saturation::processFrame (sat, in, out);
+            output[(size_t) i] = out[0];
+        }
+
+        return aliasToHarmonicDb (output, N / 3);    // 16 kHz
+    }
+
+    /** Power off the harmonic bins below aliasBandEnd relative to the harmonics (dB). */
+    static double aliasToHarmonicDb (const std::vector<float>& output, int aliasBandEnd)
+    {
+        constexpr int N = 1 << kAliasOrder;
+
+        // Last N samples: steady state, rectangular window is leakage-free
+        juce::dsp::FFT fft (kAliasOrder);
+        std::vector<float> buffer (2 * N, 0.0f);
+        std::copy (output.end() - N, output.end(), buffer.begin());
+        fft.performRealOnlyForwardTransform (buffer.data(), true);
+
+        double harmonic = 0.0, alias = 0.0;
+        for (int k = 1; k < N / 2; ++k)
+        {
+            const double p = (double) buffer[(size_t) (2 * k)] * buffer[(size_t) (2 * k)]
+                           + (double) buffer[(size_t) (2 * k + 1)] * buffer[(size_t) (2 * k + 1)];
+            if (k % kAliasBin == 0)
+                harmonic += p;
+            else if (k < aliasBandEnd)
+                alias += p;
+        }
+
+        return 10.0 * std::log10 (alias / harmonic);
+    }
+
     /** Goertzel アルゴリズムで特定周波数の振幅を計算 */
     float goertzel (const float* data, int N, float targetFreq, float sampleRate) const
     {
@@ -0,0 +1,507 @@
+#include <juce_audio_processors/juce_audio_processors.h>
+#include "../Source/DSP/VelvetNoise.h"
+#include "../Source/DSP/EarlyReflections.h"
+#include "../Source/DSP/DarkVelvetNoise.h"
+#include "../Source/DSP/HalfbandResampler.h"
+#include <cmath>
+#include <vector>
+#include <memory>
+
+//==============================================================================
+class VelvetNoiseTests : public juce::UnitTest
+{
+public:
+    VelvetNoiseTests() : juce::UnitTest ("Velvet Noise Tests") {}
+
+    void runTest() override
+    {
+        beginTest ("Shared sequence gives identical output per channel state");
+        {
+            auto sequence = DSP::VelvetNoise::PulseSequence::generate (
+                44100.0, 30.0f, 2000.0f, 0xDEADBEEFu);
+
+            DSP::VelvetNoise::ConvolverState stateA, stateB;
+            stateA.prepare (sequence->sequenceLength, 256);
+            stateB.prepare (sequence->sequenceLength, 256);
+
+            std::vector<float> input (256, 0.0f), outA (256), outB (256);
+            input[0] = 1.0f;
+
+            float maxDiff = 0.0f;
+            for (int b = 0; b < 8; ++b)
+            {
+                DSP::VelvetNoise::convolve (*sequence, stateA, input.data(), outA.data(), 256, 1.0f);
+                DSP::VelvetNoise::convolve (*sequence, stateB, input.data(), outB.data(), 256, 1.0f);
+                for (int i = 0; i < 256; ++i)
+                    maxDiff = std::max (maxDiff, std::abs (outA[(size_t) i] - outB[(size_t) i]));
+                input[0] = 0.0f;
+            }
+
+            expectEquals (maxDiff, 0.0f, "States sharing a sequence should not interfere");
+        }
+
+        beginTest ("Impulse response is independent of block size");
+        {
+            const int total = 2048;
+            std::vector<float> input (total, 0.0f);
+            input[3] = 1.0f;
+
+            auto render = [&] (int blockSize)
+            {
+                DSP::VelvetNoise ovn;
+                ovn.generate (48000.0, 30.0f, 2000.0f, 0xCAFEBABEu, blockSize);
+
+                std::vector<float> out (total, 0.0f);
+                for (int pos = 0; pos < total; pos += blockSize)
+                    ovn.convolve (input.data() + pos, out.data() + pos,
+                                  std::min (blockSize, total - pos), 1.0f);
+                return out;
+            };
+
+            auto ref = render (2048);
+            auto small = render (64);
+
+            float maxDiff = 0.0f, energy = 0.0f;
+            for (int i = 0; i < total; ++i)
+            {
+                maxDiff = std::max (maxDiff, std::abs (ref[(size_t) i] - small[(size_t) i]));
+                energy += ref[(size_t) i] * ref[(size_t) i];
+            }
+
+            expect (maxDiff < 1.0e-6f,
+                "Block size should not change the response, diff " + juce::String (maxDiff));
+            expectWithinAbsoluteError (energy, 1.0f, 0.01f,
+                "OVN response should have unity energy");
+        }
+
+        beginTest ("Sequence cache shares tables between instances");
+        {
+            DSP::VelvetNoise a, b, c;
+            a.generate (88200.0, 30.0f, 2000.0f, 0x11111111u, 512);
+            b.generate (88200.0, 30.0f, 2000.0f, 0x11111111u, 128);
+            c.generate (88200.0, 30.0f, 2000.0f, 0x22222222u, 512);
+
+            expect (a.getSequence() == b.getSequence(),
+                "Identical generation parameters should share one sequence");
+            expect (a.getSequence() != c.getSequence(),
+                "Different seeds should not share a sequence");
+
+            auto weak = std::weak_ptr<const DSP::VelvetNoise::PulseSequence> (c.getSequence());
+            c.setSequence (nullptr, 512);
+            expect (weak.expired(), "Cache should not keep unused sequences alive");
+        }
+
+        beginTest ("DVN envelope table is only rebuilt when parameters change");
+        {
+            DSP::DarkVelvetNoise dvn;
+            dvn.prepare (48000.0, 64, 0xABCD1234u, DSP::DarkVelvetNoise::Engine::sparse);
+
+            int calls = 0;
+            do { dvn.setParameters (40.0f, 2.5f); ++calls; }
+            while (dvn.isEnvelopeUpdatePending() && calls < 1000);
+
+            expect (calls > 1, "A new RT60 should be spread over several blocks");
+            expect (calls <= dvn.getNumPulses() / DSP::DarkVelvetNoise::kEnvelopePulsesPerBlock + 1,
+                "Rebuild should finish within one pass over the pulses, took " + juce::String (calls));
+
+            dvn.setParameters (40.0f, 2.5f);
+            expect (! dvn.isEnvelopeUpdatePending(), "Unchanged parameters must not start a rebuild");
+
+            // Converged table matches a fresh instance with the same settings
+            DSP::DarkVelvetNoise fresh;
+            fresh.prepare (48000.0, 64, 0xABCD1234u, DSP::DarkVelvetNoise::Engine::sparse);
+            do { fresh.setParameters (40.0f, 2.5f); }
+            while (fresh.isEnvelopeUpdatePending());
+
+            std::vector<float> in (64, 0.0f), outA (64), outB (64);
+            in[0] = 1.0f;
+            float maxDiff = 0.0f;
+            for (int b = 0; b < 50; ++b)
+            {
+                dvn.process (in.data(), outA.data(), 64, 1.0f);
+                fresh.process (in.data(), outB.data(), 64, 1.0f);
+                in[0] = 0.0f;
+                for (int i = 0; i < 64; ++i)
+                    maxDiff = std::max (maxDiff, std::abs (outA[(size_t) i] - outB[(size_t) i]));
+            }
+            expectEquals (maxDiff, 0.0f);
+        }
+
+        beginTest ("DVN prefix-sum response is independent of block size");
+        {
+            auto render = [] (int blockSize)
+            {
+                DSP::DarkVelvetNoise dvn;
+                dvn.prepare (44100.0, blockSize, 0x5678EF01u);
+                do { dvn.setParameters (60.0f, 1.5f); }
+                while (dvn.isEnvelopeUpdatePending());
+
+                const int total = 44100;
+                std::vector<float> response ((size_t) total, 0.0f);
+                std::vector<float> in ((size_t) blockSize, 0.0f);
+                for (int start = 0; start + blockSize <= total; start += blockSize)
+                {
+                    std::fill (in.begin(), in.end(), 0.0f);
+                    if (start == 0)
+                        in[0] = 1.0f;
+                    dvn.process (in.data(), response.data() + start, blockSize, 1.0f);
+                }
+                return response;
+            };
+
+            auto a = render (64);
+            auto b = render (441);
+
+            float maxDiff = 0.0f;
+            float energy = 0.0f;
+            for (int i = 0; i < 44100 - 441; ++i)
+            {
+                maxDiff = std::max (maxDiff, std::abs (a[(size_t) i] - b[(size_t) i]));
+                energy += a[(size_t) i] * a[(size_t) i];
+            }
+
+            expect (maxDiff < 1.0e-6f,
+                "Block size should not change the DVN response, diff " + juce::String (maxDiff));
+            expect (energy > 0.1f, "DVN impulse response should not be silent");
+        }
+
+        beginTest ("DVN prefix sum does not drift over a long session with DC");
+        {
+            // A short, sparse layout keeps hours of input cheap to render
+            DSP::DarkVelvetNoise::Config config;
+            config.density = 200.0f;
+            config.lengthSeconds = 0.05f;
+            config.maxPulses = 0;
+
+            constexpr int blockSize = 512;
+            auto makeDvn = [&] (DSP::DarkVelvetNoise& dvn)
+            {
+                dvn.setConfig (config);
+                dvn.prepare (48000.0, blockSize, 0x5678EF01u);
+                do { dvn.setParameters (60.0f, 1.5f); }
+                while (dvn.isEnvelopeUpdatePending());
+            };
+
+            DSP::DarkVelvetNoise longRun, fresh;
+            makeDvn (longRun);
+            makeDvn (fresh);
+
+            // Large DC plus a little noise: about 20 minutes at 48 kHz
+            uint32_t rng = 77u;
+            auto fill = [&rng] (std::vector<float>& block)
+            {
+                for (auto& x : block)
+                {
+                    rng = rng * 1664525u + 1013904223u;
+                    x = 1000.0f + (static_cast<float> (rng) / 4294967295.0f - 0.5f);
+                }
+            };
+
+            constexpr int numBlocks = 112500;
+            constexpr int freshBlocks = 8;    // > layout length: same history from here on
+            std::vector<float> in (blockSize), out (blockSize), expected (blockSize);
+            float maxDiff = 0.0f, peak = 0.0f;
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                fill (in);
+                longRun.process (in.data(), out.data(), blockSize, 1.0f);
+                if (b < numBlocks - freshBlocks)
+                    continue;
+
+                fresh.process (in.data(), expected.data(), blockSize, 1.0f);
+                if (b < numBlocks - 2)
+                    continue;
+
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    maxDiff = std::max (maxDiff, std::abs (out[(size_t) i] - expected[(size_t) i]));
+                    peak = std::max (peak, std::abs (expected[(size_t) i]));
+                }
+            }
+
+            expect (peak > 1.0f, "The DC input should come through");
+            expect (maxDiff < 1.0e-5f * peak,
+                    "Long-run output drifted by " + juce::String (maxDiff) + " at peak " + juce::String (peak));
+        }
+
+        beginTest ("DVN lead advances the response by whole samples");
+        {
+            constexpr int lead = DSP::HalfbandCoefficients::LATENCY;
+            constexpr int length = 8192;
+
+            auto render = [] (int leadSamples, DSP::DarkVelvetNoise::Engine engine)
+            {
+                DSP::DarkVelvetNoise::Config config;
+                config.leadSamples = leadSamples;
+
+                DSP::DarkVelvetNoise dvn;
+                dvn.setConfig (config);
+                dvn.prepare (22050.0, 512, 0xABCD1234u, engine);
+                do { dvn.setParameters (0.4f, 1.8f); }
+                while (dvn.isEnvelopeUpdatePending());
+
+                std::vector<float> in (length, 0.0f), out (length, 0.0f);
+                in[0] = 1.0f;
+                for (int start = 0; start < length; start += 512)
+                    dvn.process (in.data() + start, out.data() + start, 512, 1.0f);
+                return out;
+            };
+
+            const auto reference = render (0, DSP::DarkVelvetNoise::Engine::sparse);
+            for (auto engine : { DSP::DarkVelvetNoise::Engine::sparse, DSP::DarkVelvetNoise::Engine::fft })
+            {
+                const auto led = render (lead, engine);
+
+                // Pulses inside the lead fire at once; past the widest boxcar
+                // the response is the reference moved earlier by the lead
+                float maxDiff = 0.0f;
+                for (int n = 4; n < length - lead; ++n)
+                    maxDiff = std::max (maxDiff, std::abs (led[(size_t) n] - reference[(size_t) (n + lead)]));
+
+                expect (maxDiff < 1.0e-5f, "Led response should match, diff " + juce::String (maxDiff));
+            }
+        }
+
+        beginTest ("DVN FFT engine matches the sparse engine");
+        {
+            using Engine = DSP::DarkVelvetNoise::Engine;
+            const int blockSize = 128;
+
+            DSP::DarkVelvetNoise sparse, fft;
+            sparse.prepare (48000.0, blockSize, 0x5678EF01u, Engine::sparse);
+            fft.prepare (48000.0, blockSize, 0x5678EF01u, Engine::fft);
+            expect (! sparse.usesFFTEngine());
+            expect (fft.usesFFTEngine());
+
+            // Both must pick up an RT60 change before comparing
+            do
+            {
+                sparse.setParameters (30.0f, 1.2f);
+                fft.setParameters (30.0f, 1.2f);
+            }
+            while (sparse.isEnvelopeUpdatePending() || fft.isEnvelopeUpdatePending());
+
+            uint32_t rng = 42u;
+            std::vector<float> in (blockSize), outS (blockSize), outF (blockSize);
+            float maxDiff = 0.0f;
+            for (int b = 0; b < 48000 * 2 / blockSize; ++b)
+            {
+                for (auto& x : in)
+                {
+                    rng = rng * 1664525u + 1013904223u;
+                    x = b < 20 ? static_cast<float> (rng) / 4294967295.0f - 0.5f : 0.0f;
+                }
+
+                sparse.process (in.data(), outS.data(), blockSize, 1.0f);
+                fft.process (in.data(), outF.data(), blockSize, 1.0f);
+                for (int i = 0; i < blockSize; ++i)
+                    maxDiff = std::max (maxDiff, std::abs (outS[(size_t) i] - outF[(size_t) i]));
+            }
+
+            expect (maxDiff < 1.0e-5f, "Engines should agree, diff " + juce::String (maxDiff));
+        }
+
+        beginTest ("DVN pulse count follows density x length at any sample rate");
+        {
+            for (double rate : { 44100.0, 96000.0, 192000.0 })
+            {
+                DSP::DarkVelvetNoise dvn;
+                DSP::DarkVelvetNoise::Config config;
+                config.density = 2000.0f;
+                config.lengthSeconds = 1.5f;
+                config.maxPulses = 0;
+                dvn.setConfig (config);
+                dvn.prepare (rate, 256, 0x2468ACE0u, DSP::DarkVelvetNoise::Engine::sparse);
+
+                expectWithinAbsoluteError (dvn.getNumPulses(), 3000, 1,
+                    "Pulse count at " + juce::String (rate) + " Hz");
+
+                config.maxPulses = 1000;
+                dvn.setConfig (config);
+                dvn.prepare (rate, 256, 0x2468ACE0u, DSP::DarkVelvetNoise::Engine::sparse);
+                expectWithinAbsoluteError (dvn.getNumPulses(), 1000, 1,
+                    "Capped pulse count at " + juce::String (rate) + " Hz");
+            }
+        }
+
+        beginTest ("DVN keeps the integer-grid pulse positions where the grid is whole");
+        {
+            // 48 kHz at 1600 pulses/s is a 30-sample grid: the fractional
+            // grid must reproduce the original m * grid + rng % grid layout
+            constexpr uint32_t seed = 0xABCD1234u;
+            constexpr int gridSize = 30;
+
+            DSP::DarkVelvetNoise::Config config;
+            config.density = 1600.0f;
+            config.maxPulses = 500;
+
+            DSP::DarkVelvetNoise dvn;
+            dvn.setConfig (config);
+            dvn.prepare (48000.0, 256, seed);
+
+            const auto* layout = dvn.getLayout();
+            expect (layout != nullptr);
+            expectEquals (static_cast<int> (layout->pulses.size()), 500);
+
+            uint32_t rng = seed;
+            bool allMatch = true;
+            for (size_t m = 0; m < layout->pulses.size(); ++m)
+            {
+                rng = rng * 1664525u + 1013904223u;
+                const int position = static_cast<int> (m) * gridSize + static_cast<int> (rng % static_cast<uint32_t> (gridSize));
+                rng = rng * 1664525u + 1013904223u;
+                const float sign = (rng & 0x80000000u) ? -1.0f : 1.0f;
+                rng = rng * 1664525u + 1013904223u;
+                const int width = 1 + static_cast<int> (rng % 4u);
+
+                const auto& pulse = layout->pulses[m];
+                allMatch = allMatch && pulse.position == position && pulse.sign == sign && pulse.width == width;
+            }
+            expect (allMatch, "Integer-grid layout should be unchanged");
+        }
+
+        beginTest ("Stereo early reflections share one pulse grid with per-channel signs");
+        {
+            const uint32_t seeds[2] = { 0xDEADBEEFu, 0xCAFEBABEu };
+            const int blockSize = 200;
+
+            DSP::EarlyReflections er;
+            er.prepare (44100.0, blockSize, seeds, 2, 0);
+
+            // Left is the first seed's OVN; right takes its positions and
+            // envelope with the second seed's signs
+            auto left  = DSP::VelvetNoise::PulseSequence::generate (44100.0, 30.0f, 2000.0f, seeds[0]);
+            auto signs = DSP::VelvetNoise::PulseSequence::generate (44100.0, 30.0f, 2000.0f, seeds[1]);
+            expectEquals (er.getNumTaps(), (int) left->pulses.size(), "One tap per grid pulse, not per channel");
+
+            DSP::VelvetNoise::PulseSequence right = *left;
+            for (size_t k = 0; k < right.pulses.size(); ++k)
+            {
+                right.pulses[k].sign = signs->pulses[k].sign;
+                right.coefficients[k] = right.pulses[k].sign * right.envelopes[k] * right.normGain;
+            }
+
+            DSP::VelvetNoise::ConvolverState stateL, stateR;
+            stateL.prepare (left->sequenceLength, blockSize);
+            stateR.prepare (right.sequenceLength, blockSize);
+
+            std::vector<float> inL (blockSize), inR (blockSize);
+            std::vector<float> outL (blockSize), outR (blockSize);
+            std::vector<float> expL (blockSize), expR (blockSize);
+
+            uint32_t rng = 0x2468ACE0u;
+            float maxDiff = 0.0f;
+            for (int b = 0; b < 20; ++b)
+            {
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    rng = rng * 1664525u + 1013904223u;
+                    inL[(size_t) i] = (static_cast<float> (rng) / static_cast<float> (0xFFFFFFFFu)) * 2.0f - 1.0f;
+                    inR[(size_t) i] = (b < 10) ? -0.5f * inL[(size_t) i] : 0.0f;
+                }
+
+                const float* ins[2] = { inL.data(), inR.data() };
+                float* outs[2] = { outL.data(), outR.data() };
+                er.process (ins, outs, blockSize, 0.5f, 0);
+
+                DSP::VelvetNoise::convolve (*left, stateL, inL.data(), expL.data(), blockSize, 0.5f);
+                DSP::VelvetNoise::convolve (right, stateR, inR.data(), expR.data(), blockSize, 0.5f);
+
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    maxDiff = std::max (maxDiff, std::abs (outL[(size_t) i] - expL[(size_t) i]));
+                    maxDiff = std::max (maxDiff, std::abs (outR[(size_t) i] - expR[(size_t) i]));
+                }
+            }
+
+            expect (maxDiff < 1.0e-5f,
+                "Shared-grid taps should reproduce the per-channel convolutions, diff "
+                + juce::String (maxDiff));
+
+            // The sign patterns alone keep the channels decorrelated
+            double xy = 0.0, xx = 0.0, yy = 0.0;
+            for (size_t k = 0; k < right.pulses.size(); ++k)
+            {
+                xy += (double) left->coefficients[k] * right.coefficients[k];
+                xx += (double) left->coefficients[k] * left->coefficients[k];
+                yy += (double) right.coefficients[k] * right.coefficients[k];
+            }
+            const double correlation = xy / std::sqrt (xx * yy);
+            expect (std::abs (correlation) < 0.3, "L/R correlation " + juce::String (correlation));
+        }
+
+        beginTest ("Early reflection instances share their pulse sequences");
+        {
+            const uint32_t seeds[2] = { 0x0BADF00Du, 0x600DCAFEu };
+            DSP::EarlyReflections a, b;
+            a.prepare (96000.0, 256, seeds, 2, 0, 25.0f, 1500.0f);
+            b.prepare (96000.0, 512, seeds, 2, 0, 25.0f, 1500.0f);
+
+            expect (a.getSequence (0) != nullptr);
+            expect (a.getSequence (0) == b.getSequence (0), "Same parameters should share one sequence");
+            expect (a.getSequence (1) == b.getSequence (1));
+            expect (a.getSequence (0) != a.getSequence (1), "Channels keep their own seeds");
+
+            // Still the same objects after a regeneration elsewhere
+            const auto* first = a.getSequence (0);
+            DSP::EarlyReflections c;
+            c.prepare (96000.0, 256, seeds, 2, 0, 25.0f, 1500.0f);
+            expect (c.getSequence (0) == first);
+        }
+
+        beginTest ("Pre-delay is folded into the early reflection taps");
+        {
+            const uint32_t seeds[2] = { 0xDEADBEEFu, 0xCAFEBABEu };
+            const int blockSize = 128;
+            const int preDelay = 300;
+
+            DSP::EarlyReflections er;
+            er.prepare (44100.0, blockSize, seeds, 2, 4410);
+
+            std::vector<float> in (blockSize, 0.0f);
+            std::vector<float> erL (blockSize), erR (blockSize);
+            in[0] = 1.0f;
+
+            int firstEarly = -1;
+            for (int b = 0; b < 40; ++b)
+            {
+                const float* ins[2] = { in.data(), in.data() };
+                float* outs[2] = { erL.data(), erR.data() };
+                er.process (ins, outs, blockSize, 1.0f, preDelay);
+                in[0] = 0.0f;
+
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    if (firstEarly < 0 && std::abs (erL[(size_t) i]) > 1.0e-9f)
+                        firstEarly = b * blockSize + i;
+                }
+            }
+
+            expect (firstEarly >= preDelay,
+                "No early reflection may precede the pre-delay, first at "
+                + juce::String (firstEarly));
+        }
+
+        beginTest ("Regenerated pattern is swapped in at a block boundary");
+        {
+            const uint32_t seeds[2] = { 0x1234u, 0x5678u };
+            DSP::EarlyReflections er;
+            er.prepare (48000.0, 256, seeds, 2, 0, 30.0f, 2000.0f);
+            const int tapsBefore = er.getNumTaps();
+
+            expect (er.generatePattern (60.0f, 3000.0f), "Back table should be free after prepare");
+            expect (! er.generatePattern (20.0f, 1000.0f), "A second request must wait for the swap");
+
+            std::vector<float> in (256, 0.0f), outL (256), outR (256);
+            const float* ins[2] = { in.data(), in.data() };
+            float* outs[2] = { outL.data(), outR.data() };
+            for (int b = 0; b < 10; ++b)
+                er.process (ins, outs, 256, 1.0f, 0);
+
+            expect (! er.isPatternSwapPending(), "Swap should complete after the crossfade");
+            expect (er.getNumTaps() > tapsBefore, "Longer, denser pattern should have more taps");
+        }
+    }
+};
+
+static VelvetNoiseTests velvetNoiseTests;